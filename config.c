@@ -5,6 +5,7 @@
 #include <unistd.h>
 #include <sys/stat.h>
 #include <errno.h>
+#include <math.h>
 #include <pwd.h>
 
 #include "mouse_config.h"
@@ -45,37 +46,146 @@ static bool ensure_config_dir(void) {
     return true;
 }
 
-// Parse a config line
-static bool parse_config_line(const char *line, MouseConfig *config) {
-    char key[64], value[64];
-    if (sscanf(line, "%63s = %63s", key, value) != 2) {
-        return false;
-    }
-    
+bool imu_rate_supported(int rate) {
+    return rate == 60 || rate == 90 || rate == 120 || rate == 240;
+}
+
+// Convert a per-sample smoothing factor to a time constant and back. A factor
+// s keeps s of the previous value each sample, i.e. exp(-interval / tau).
+static float smoothing_time_constant(float factor) {
+    if (factor <= 0.0f) return 0.0f;
+    if (factor > 0.99f) factor = 0.99f;
+    return -1000.0f / (LEGACY_SAMPLE_RATE * logf(factor));
+}
+
+float legacy_smoothing_factor(float smoothing_ms) {
+    if (smoothing_ms <= 0.0f) return 0.0f;
+    return expf(-1000.0f / (LEGACY_SAMPLE_RATE * smoothing_ms));
+}
+
+static bool parse_bool(const char *value) {
+    return strcmp(value, "true") == 0 || strcmp(value, "1") == 0;
+}
+
+// Apply one setting by key
+bool set_config_value(MouseConfig *config, const char *key, const char *value) {
     if (strcmp(key, "sensitivity_yaw") == 0) {
         config->sensitivity_yaw = atof(value);
     } else if (strcmp(key, "sensitivity_pitch") == 0) {
         config->sensitivity_pitch = atof(value);
+    } else if (strcmp(key, "imu_rate") == 0) {
+        int rate = atoi(value);
+        if (!imu_rate_supported(rate)) return false;
+        config->imu_rate = rate;
+    } else if (strcmp(key, "disabled_imu") == 0) {
+        if (strcmp(value, "off") == 0) {
+            config->disabled_imu = IMU_DISABLED_OFF;
+        } else if (strcmp(value, "low") == 0) {
+            config->disabled_imu = IMU_DISABLED_LOW;
+        } else if (strcmp(value, "full") == 0) {
+            config->disabled_imu = IMU_DISABLED_FULL;
+        } else {
+            return false;
+        }
+    } else if (strcmp(key, "still_timeout_ms") == 0) {
+        int timeout = atoi(value);
+        if (timeout < 0) return false;
+        config->still_timeout_ms = timeout;
+    } else if (strcmp(key, "still_threshold") == 0) {
+        float threshold = atof(value);
+        if (threshold < 0.0f) return false;
+        config->still_threshold = threshold;
+    } else if (strcmp(key, "deadzone_speed") == 0) {
+        config->deadzone_speed = atof(value);
     } else if (strcmp(key, "deadzone") == 0) {
-        config->deadzone = atof(value);
+        config->deadzone_speed = atof(value) * LEGACY_SAMPLE_RATE;
+    } else if (strcmp(key, "smoothing_ms") == 0) {
+        config->smoothing_ms = atof(value);
     } else if (strcmp(key, "smoothing") == 0) {
-        config->smoothing = atof(value);
+        config->smoothing_ms = smoothing_time_constant(atof(value));
+    } else if (strcmp(key, "filter") == 0) {
+        if (strcmp(value, "legacy") == 0) {
+            config->filter = FILTER_LEGACY;
+        } else if (strcmp(value, "one_euro") == 0) {
+            config->filter = FILTER_ONE_EURO;
+        } else {
+            return false;
+        }
+    } else if (strcmp(key, "euro_min_cutoff") == 0) {
+        float cutoff = atof(value);
+        if (cutoff <= 0.0f) return false;
+        config->euro_min_cutoff = cutoff;
+    } else if (strcmp(key, "euro_beta") == 0) {
+        float beta = atof(value);
+        if (beta < 0.0f) return false;
+        config->euro_beta = beta;
     } else if (strcmp(key, "roll_scroll_threshold") == 0) {
         config->roll_scroll_threshold = atof(value);
+    } else if (strcmp(key, "scroll_hysteresis") == 0) {
+        // Scrolling has to stop somewhere short of level
+        float hysteresis = atof(value);
+        if (hysteresis < 0.0f || hysteresis >= config->roll_scroll_threshold) return false;
+        config->scroll_hysteresis = hysteresis;
+    } else if (strcmp(key, "scroll_speed") == 0) {
+        config->scroll_speed = atof(value);
+    } else if (strcmp(key, "scroll_curve") == 0) {
+        float curve = atof(value);
+        if (curve <= 0.0f) return false;
+        config->scroll_curve = curve;
+    } else if (strcmp(key, "scroll_max_speed") == 0) {
+        float speed = atof(value);
+        if (speed < 0.0f) return false;
+        config->scroll_max_speed = speed;
+    } else if (strcmp(key, "scroll_axis") == 0) {
+        if (strcmp(value, "vertical") == 0) {
+            config->scroll_axis = SCROLL_VERTICAL;
+        } else if (strcmp(value, "horizontal") == 0) {
+            config->scroll_axis = SCROLL_HORIZONTAL;
+        } else {
+            return false;
+        }
     } else if (strcmp(key, "scroll_sensitivity") == 0) {
-        config->scroll_sensitivity = atof(value);
+        config->scroll_speed = atof(value) * LEGACY_SAMPLE_RATE;
     } else if (strcmp(key, "invert_x") == 0) {
-        config->invert_x = (strcmp(value, "true") == 0 || strcmp(value, "1") == 0);
+        config->invert_x = parse_bool(value);
     } else if (strcmp(key, "invert_y") == 0) {
-        config->invert_y = (strcmp(value, "true") == 0 || strcmp(value, "1") == 0);
+        config->invert_y = parse_bool(value);
     } else if (strcmp(key, "invert_scroll") == 0) {
-        config->invert_scroll = (strcmp(value, "true") == 0 || strcmp(value, "1") == 0);
+        config->invert_scroll = parse_bool(value);
+    } else if (strcmp(key, "use_quaternion") == 0) {
+        config->use_quaternion = parse_bool(value);
+    } else if (strcmp(key, "prediction_ms") == 0) {
+        config->prediction_ms = atof(value);
+    } else if (strcmp(key, "output_rate") == 0) {
+        int rate = atoi(value);
+        if (rate < 0 || rate > 1000) return false;
+        config->output_rate = rate;
+    } else if (strcmp(key, "absolute_mode") == 0) {
+        config->absolute_mode = parse_bool(value);
     } else if (strcmp(key, "yaw_range") == 0) {
-        config->yaw_range = atof(value);
+        float range = atof(value);
+        if (range <= 0.0f) return false;
+        config->yaw_range = range;
     } else if (strcmp(key, "pitch_range") == 0) {
-        config->pitch_range = atof(value);
+        float range = atof(value);
+        if (range <= 0.0f) return false;
+        config->pitch_range = range;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+// Parse a config line
+static bool parse_config_line(const char *line, MouseConfig *config) {
+    char key[64], value[64];
+    if (sscanf(line, "%63s = %63s", key, value) != 2) {
+        return false;
     }
     
+    if (!set_config_value(config, key, value)) {
+        fprintf(stderr, "Warning: Ignoring config setting %s = %s\n", key, value);
+    }
     return true;
 }
 
@@ -118,19 +228,52 @@ bool save_config_file(const char *path, const MouseConfig *config) {
     fprintf(file, "sensitivity_yaw = %.1f\n", config->sensitivity_yaw);
     fprintf(file, "sensitivity_pitch = %.1f\n\n", config->sensitivity_pitch);
     
-    fprintf(file, "# Movement filtering\n");
-    fprintf(file, "deadzone = %.2f\n", config->deadzone);
-    fprintf(file, "smoothing = %.2f\n\n", config->smoothing);
+    fprintf(file, "# IMU sample rate in Hz (60, 90, 120 or 240); other settings are rate-independent\n");
+    fprintf(file, "imu_rate = %d\n\n", config->imu_rate);
+    
+    fprintf(file, "# Power saving: IMU stream while tracking is off (off, low or full), and how long\n");
+    fprintf(file, "# the head stays still (ms, 0 = never) before dropping to 60 Hz until it moves\n");
+    fprintf(file, "# faster than still_threshold (degrees/second)\n");
+    fprintf(file, "disabled_imu = %s\n", config->disabled_imu == IMU_DISABLED_LOW ? "low" :
+                                          config->disabled_imu == IMU_DISABLED_FULL ? "full" : "off");
+    fprintf(file, "still_timeout_ms = %d\n", config->still_timeout_ms);
+    fprintf(file, "still_threshold = %.1f\n\n", config->still_threshold);
+    
+    fprintf(file, "# Movement filtering (deadzone in degrees/second, smoothing time constant in ms)\n");
+    fprintf(file, "deadzone_speed = %.2f\n", config->deadzone_speed);
+    fprintf(file, "smoothing_ms = %.2f\n\n", config->smoothing_ms);
     
-    fprintf(file, "# Scroll control\n");
+    fprintf(file, "# Pose filter: legacy (smoothing_ms above) or one_euro (adaptive)\n");
+    fprintf(file, "filter = %s\n", config->filter == FILTER_ONE_EURO ? "one_euro" : "legacy");
+    fprintf(file, "euro_min_cutoff = %.2f\n", config->euro_min_cutoff);
+    fprintf(file, "euro_beta = %.3f\n\n", config->euro_beta);
+    
+    fprintf(file, "# Scroll control: lines/second = scroll_speed * (degrees past threshold) ^ scroll_curve,\n");
+    fprintf(file, "# up to scroll_max_speed (0 = no limit); stops scroll_hysteresis degrees below the threshold\n");
     fprintf(file, "roll_scroll_threshold = %.1f\n", config->roll_scroll_threshold);
-    fprintf(file, "scroll_sensitivity = %.2f\n\n", config->scroll_sensitivity);
+    fprintf(file, "scroll_hysteresis = %.1f\n", config->scroll_hysteresis);
+    fprintf(file, "scroll_speed = %.2f\n", config->scroll_speed);
+    fprintf(file, "scroll_curve = %.2f\n", config->scroll_curve);
+    fprintf(file, "scroll_max_speed = %.1f\n", config->scroll_max_speed);
+    fprintf(file, "scroll_axis = %s\n\n", config->scroll_axis == SCROLL_HORIZONTAL ? "horizontal" : "vertical");
     
     fprintf(file, "# Axis inversion\n");
     fprintf(file, "invert_x = %s\n", config->invert_x ? "true" : "false");
     fprintf(file, "invert_y = %s\n", config->invert_y ? "true" : "false");
     fprintf(file, "invert_scroll = %s\n\n", config->invert_scroll ? "true" : "false");
     
+    fprintf(file, "# Orientation source (quaternion compensates for head roll)\n");
+    fprintf(file, "use_quaternion = %s\n\n", config->use_quaternion ? "true" : "false");
+    
+    fprintf(file, "# Pose prediction in milliseconds, hides pipeline and compositor lag (0 = off)\n");
+    fprintf(file, "prediction_ms = %.1f\n\n", config->prediction_ms);
+    
+    fprintf(file, "# Output rate in Hz, e.g. your display refresh rate (0 = emit every IMU sample)\n");
+    fprintf(file, "output_rate = %d\n\n", config->output_rate);
+    
+    fprintf(file, "# Absolute positioning: head direction maps straight to a screen position\n");
+    fprintf(file, "absolute_mode = %s\n\n", config->absolute_mode ? "true" : "false");
+    
     fprintf(file, "# Screen mapping ranges (degrees)\n");
     fprintf(file, "yaw_range = %.1f\n", config->yaw_range);
     fprintf(file, "pitch_range = %.1f\n", config->pitch_range);
@@ -139,24 +282,26 @@ bool save_config_file(const char *path, const MouseConfig *config) {
     return true;
 }
 
-// Load config with fallback order: user -> system -> defaults
-void load_config(MouseConfig *config) {
+// Load config with fallback order: user -> system -> defaults.
+// Returns the file it loaded, or NULL when using defaults.
+const char* load_config(MouseConfig *config) {
     char *user_path = get_user_config_path();
     
     // Try user config first
     if (user_path && load_config_file(user_path, config)) {
         printf("Loaded config from: %s\n", user_path);
-        return;
+        return user_path;
     }
     
     // Try system config
     if (load_config_file(SYSTEM_CONFIG_PATH, config)) {
         printf("Loaded config from: %s\n", SYSTEM_CONFIG_PATH);
-        return;
+        return SYSTEM_CONFIG_PATH;
     }
     
     // Defaults are already set in the MouseConfig initialization
     printf("Using default configuration\n");
+    return NULL;
 }
 
 // Save current config to user file
@@ -0,0 +1,94 @@
+// Config file checks (ctest, or run directly). Older config files state
+// deadzone, smoothing and scroll_sensitivity per sample at 120 Hz; they must
+// load as the equivalent rate-independent settings, and the pipeline must
+// turn those back into the same per-sample values at 120 Hz.
+//
+// Usage: config_test
+// Prints each mismatch and a summary line; exits non-zero on any mismatch.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <unistd.h>
+
+#include "mouse_config.h"
+#include "motion_pipeline.h"
+
+static unsigned long checks;
+static unsigned long failures;
+
+static void expect_near(const char *check, const char *what, double got, double want,
+                        double tolerance) {
+    checks++;
+    if (fabs(got - want) > tolerance) {
+        failures++;
+        printf("FAIL check=%s %s=%.4f, expected %.4f +- %.4f\n", check, what, got, want, tolerance);
+    }
+}
+
+// The legacy keys one at a time
+static void test_legacy_values(void) {
+    MouseConfig config = { .imu_rate = 120 };
+
+    set_config_value(&config, "deadzone", "0.05");
+    expect_near("legacy", "deadzone_speed", config.deadzone_speed, 6.0, 1e-4);
+
+    set_config_value(&config, "scroll_sensitivity", "0.1");
+    expect_near("legacy", "scroll_speed", config.scroll_speed, 12.0, 1e-4);
+
+    // A factor s keeps s of the previous value per 1/120 s sample
+    set_config_value(&config, "smoothing", "0.5");
+    expect_near("legacy", "smoothing_ms", config.smoothing_ms, -1000.0 / (120.0 * log(0.5)), 1e-3);
+    expect_near("legacy", "smoothing_factor", legacy_smoothing_factor(config.smoothing_ms), 0.5, 1e-5);
+
+    set_config_value(&config, "smoothing", "0");
+    expect_near("legacy", "smoothing_off_ms", config.smoothing_ms, 0.0, 0.0);
+}
+
+// A legacy config file, and the per-sample values the pipeline derives from
+// it at 120 Hz (the old behaviour) and at 240 Hz (half per sample, the same
+// per second)
+static void test_legacy_file(void) {
+    char path[] = "/tmp/config_test_XXXXXX";
+    int fd = mkstemp(path);
+    FILE *file = fd >= 0 ? fdopen(fd, "w") : NULL;
+    checks++;
+    if (!file) {
+        failures++;
+        printf("FAIL check=legacy_file could not create a test config\n");
+        return;
+    }
+    fprintf(file, "# Older config\ndeadzone = 0.05\nsmoothing = 0.5\nscroll_sensitivity = 0.1\n");
+    fclose(file);
+
+    MouseConfig config = { .imu_rate = 120, .filter = FILTER_LEGACY };
+    checks++;
+    if (!load_config_file(path, &config)) {
+        failures++;
+        printf("FAIL check=legacy_file could not load %s\n", path);
+    }
+    unlink(path);
+
+    expect_near("legacy_file", "deadzone_speed", config.deadzone_speed, 6.0, 1e-4);
+    expect_near("legacy_file", "scroll_speed", config.scroll_speed, 12.0, 1e-4);
+
+    MotionConfig prepared;
+    motion_config_prepare(&prepared, &config);
+    expect_near("legacy_file", "deadzone_120hz", prepared.params.deadzone, 0.05, 1e-5);
+    expect_near("legacy_file", "smoothing_120hz", prepared.params.smoothing, 0.5, 1e-5);
+    expect_near("legacy_file", "scroll_gain_120hz", prepared.params.scroll_gain, 0.1, 1e-5);
+
+    config.imu_rate = 240;
+    motion_config_prepare(&prepared, &config);
+    expect_near("legacy_file", "deadzone_240hz", prepared.params.deadzone, 0.025, 1e-5);
+    expect_near("legacy_file", "smoothing_240hz", prepared.params.smoothing, sqrt(0.5), 1e-5);
+    expect_near("legacy_file", "scroll_gain_240hz", prepared.params.scroll_gain, 0.05, 1e-5);
+}
+
+int main(void) {
+    test_legacy_values();
+    test_legacy_file();
+
+    printf("test=config checks=%lu failures=%lu\n", checks, failures);
+    return failures == 0 ? 0 : 1;
+}
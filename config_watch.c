@@ -0,0 +1,125 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <poll.h>
+#include <sys/stat.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+
+#include "config_watch.h"
+
+// Events that mean the file has new contents
+#define WATCH_EVENTS (IN_CLOSE_WRITE | IN_MOVED_TO)
+
+// Read pending inotify events; true if any concerned our file
+static bool file_changed(ConfigWatch *watch) {
+    char buffer[4096] __attribute__((aligned(__alignof__(struct inotify_event))));
+    bool changed = false;
+    ssize_t len;
+    
+    while ((len = read(watch->inotify_fd, buffer, sizeof(buffer))) > 0) {
+        for (char *ptr = buffer; ptr < buffer + len; ) {
+            const struct inotify_event *event = (const struct inotify_event *)ptr;
+            if (event->len > 0 && strcmp(event->name, watch->name) == 0) {
+                changed = true;
+            }
+            ptr += sizeof(struct inotify_event) + event->len;
+        }
+    }
+    return changed;
+}
+
+// Create dir and any missing parents (mkdir -p), so a config saved there
+// later is seen even if the directory doesn't exist yet
+static bool make_dirs(const char *dir) {
+    char path[1024];
+    snprintf(path, sizeof(path), "%s", dir);
+    
+    for (char *p = path + 1; ; p++) {
+        if (*p != '/' && *p != '\0') continue;
+        char end = *p;
+        *p = '\0';
+        if (mkdir(path, 0755) == -1 && errno != EEXIST) {
+            fprintf(stderr, "Warning: Cannot create %s: %s\n", path, strerror(errno));
+            return false;
+        }
+        *p = end;
+        if (end == '\0') return true;
+    }
+}
+
+static void* config_watch_thread(void *arg) {
+    ConfigWatch *watch = (ConfigWatch *)arg;
+    struct pollfd fds[2] = {
+        { .fd = watch->inotify_fd, .events = POLLIN },
+        { .fd = watch->wake_fd, .events = POLLIN }
+    };
+    
+    while (poll(fds, 2, -1) >= 0 || errno == EINTR) {
+        if (fds[1].revents) break;
+        if ((fds[0].revents & POLLIN) && file_changed(watch) && watch->on_change) {
+            watch->on_change();
+        }
+    }
+    return NULL;
+}
+
+bool config_watch_start(ConfigWatch *watch, const char *path) {
+    char dir[1024];
+    const char *slash = strrchr(path, '/');
+    if (slash) {
+        snprintf(dir, sizeof(dir), "%.*s", (int)(slash - path), path);
+        if (dir[0] == '\0') strcpy(dir, "/");
+        snprintf(watch->name, sizeof(watch->name), "%s", slash + 1);
+    } else {
+        strcpy(dir, ".");
+        snprintf(watch->name, sizeof(watch->name), "%s", path);
+    }
+    
+    struct stat st;
+    if (stat(dir, &st) == -1 && errno == ENOENT && make_dirs(dir)) {
+        printf("Created %s for the config file\n", dir);
+    }
+    
+    watch->inotify_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (watch->inotify_fd < 0) {
+        perror("Failed to initialize inotify");
+        return false;
+    }
+    if (inotify_add_watch(watch->inotify_fd, dir, WATCH_EVENTS) < 0) {
+        fprintf(stderr, "Warning: Cannot watch %s for config changes\n", dir);
+        close(watch->inotify_fd);
+        return false;
+    }
+    
+    watch->wake_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (watch->wake_fd < 0) {
+        perror("Failed to create config watch eventfd");
+        close(watch->inotify_fd);
+        return false;
+    }
+    
+    if (pthread_create(&watch->thread, NULL, config_watch_thread, watch) != 0) {
+        perror("Failed to create config watch thread");
+        close(watch->inotify_fd);
+        close(watch->wake_fd);
+        return false;
+    }
+    watch->running = true;
+    return true;
+}
+
+void config_watch_stop(ConfigWatch *watch) {
+    if (!watch->running) return;
+    watch->running = false;
+    
+    uint64_t one = 1;
+    if (write(watch->wake_fd, &one, sizeof(one)) < 0) {
+        perror("Failed to wake config watch");
+    }
+    pthread_join(watch->thread, NULL);
+    close(watch->inotify_fd);
+    close(watch->wake_fd);
+}
@@ -0,0 +1,25 @@
+#ifndef CONFIG_WATCH_H
+#define CONFIG_WATCH_H
+
+#include <stdbool.h>
+#include <pthread.h>
+
+// Watches the config file with inotify and calls on_change from its own
+// thread whenever the file is rewritten. The directory is watched rather than
+// the file, so editors that save by writing a new file and renaming it over
+// the old one are seen too. A missing directory is created first, so a config
+// saved for the first time while the daemon runs still gets picked up.
+typedef struct {
+    int inotify_fd;
+    int wake_fd;                // eventfd that tells the watch thread to exit
+    char name[256];             // File name within the watched directory
+    pthread_t thread;
+    bool running;
+
+    void (*on_change)(void);    // Set before config_watch_start
+} ConfigWatch;
+
+bool config_watch_start(ConfigWatch *watch, const char *path);
+void config_watch_stop(ConfigWatch *watch);
+
+#endif // CONFIG_WATCH_H
@@ -0,0 +1,749 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <time.h>
+#include <pthread.h>
+#include <getopt.h>
+
+#include "viture.h"
+#include "daemon_common.h"
+#include "motion_emitter.h"
+#include "latency_histogram.h"
+#include "imu_capture.h"
+#include "pose_export.h"
+#include "config_watch.h"
+#include "socket_server.h"
+#include "event_loop.h"
+#include "imu_power.h"
+
+// Global variables
+static const DaemonOutput *output;      // The daemon's output backend
+static uint64_t startup_ns;             // When main started, for time to first event
+static bool first_event_emitted = false;
+static MouseConfig config = {
+    .sensitivity_yaw = 45.0,    // Higher sensitivity for fixed-cursor feel
+    .sensitivity_pitch = 45.0,  // Higher sensitivity for fixed-cursor feel
+    .imu_rate = IMU_RATE_DEFAULT,
+    .disabled_imu = IMU_DISABLED_OFF, // Stop the IMU stream while tracking is off
+    .still_timeout_ms = 10000,  // 60 Hz after 10 s without head motion
+    .still_threshold = 3.0,     // Degrees/second that count as motion
+    .deadzone_speed = 0.0,      // No deadzone for immediate response
+    .smoothing_ms = 0.0,        // No smoothing for direct control
+    .filter = FILTER_LEGACY,
+    .euro_min_cutoff = 1.0,     // Hz at rest
+    .euro_beta = 0.2,           // Hz per degree/second of head speed
+    .roll_scroll_threshold = 20.0, // Degrees of roll to trigger scrolling
+    .scroll_hysteresis = 3.0,   // Keep scrolling until 3 degrees back inside the threshold
+    .scroll_speed = 12.0,       // Lines/second at one degree past the threshold
+    .scroll_curve = 1.0,        // Linear in the degrees past the threshold
+    .scroll_max_speed = 40.0,   // Lines/second at most
+    .scroll_axis = SCROLL_VERTICAL,
+    .invert_x = false,
+    .invert_y = true,           // Inverted Y for natural movement
+    .invert_scroll = false,
+    .use_quaternion = false,    // Euler deltas by default
+    .prediction_ms = 0.0,       // No prediction
+    .output_rate = 0,           // Emit as samples arrive
+    .absolute_mode = false,     // Relative movement like a regular mouse
+    .yaw_range = 40.0,          // 40 degrees yaw covers screen width
+    .pitch_range = 25.0         // 25 degrees pitch covers screen height
+};
+static bool enabled = true;
+static bool paused = false;
+static bool debug_mode = false;
+static bool imu_streaming = false;      // Glasses are streaming (not replaying)
+static ImuPower imu_power;
+static SocketServer socket_server;
+static MotionEmitter emitter;
+
+// Control threads (console, socket server, config watch) edit config under
+// config_lock and then publish a copy to the emitter; the IMU and emitter
+// threads only ever see published copies
+static pthread_mutex_t config_lock;
+static char config_file[1024];          // Config file in use, watched for changes
+static ConfigWatch config_watch;
+static LatencyHistogram callback_latency;
+static ImuCaptureWriter capture;
+static bool recording = false;
+static PoseExportWriter pose_export;
+
+// Emitter thread: hand one frame to the output
+static void emit_output(const MotionOutput *out)
+{
+    socket_server_publish_motion(&socket_server, out->move_x, out->move_y, out->scroll);
+    
+    output->emit(out, motion_emitter_config(&emitter), debug_mode);
+    
+    if (!first_event_emitted) {
+        first_event_emitted = true;
+        printf("First event emitted %.1f ms after startup\n", (latency_now_ns() - startup_ns) / 1e6);
+    }
+}
+
+// Emitter thread: per-sample subscriber and debug output
+static void trace_sample(const MotionSample *sample)
+{
+    socket_server_publish_pose(&socket_server, sample->yaw, sample->pitch, sample->roll);
+    
+    if (debug_mode) {
+        printf("IMU: roll=%f pitch=%f yaw=%f\n", sample->roll, sample->pitch, sample->yaw);
+    }
+}
+
+// Decode an IMU packet and hand it off to the emitter thread. time_ns times
+// the pose stage: the arrival time live, the recorded one when replaying.
+static void handle_imu(uint8_t *data, uint16_t len, uint32_t ts, uint64_t arrival_ns, uint64_t time_ns)
+{
+    // Record raw packets before any filtering so replays see exactly what we saw
+    if (recording) {
+        imu_capture_append(&capture, data, len, ts);
+    }
+    
+    MotionSample sample;
+    motion_decode(data, len, ts, &sample);
+    sample.arrival_ns = arrival_ns;
+    sample.time_ns = time_ns;
+    
+    // Shared-memory consumers get the pose even while tracking is off (as
+    // long as disabled_imu keeps the stream running)
+    pose_export_publish(&pose_export, &sample);
+    
+    imu_power_sample(&imu_power, &sample);
+    
+    if (!enabled || paused || (output->ready && !output->ready())) return;
+    
+    motion_emitter_push(&emitter, &sample);
+    
+    latency_histogram_record(&callback_latency, latency_now_ns() - arrival_ns);
+}
+
+// IMU data callback from glasses
+static void imuCallback(uint8_t *data, uint16_t len, uint32_t ts)
+{
+    uint64_t arrival_ns = latency_now_ns();
+    handle_imu(data, len, ts, arrival_ns, arrival_ns);
+}
+
+// Replayed capture record, timed as it was recorded whatever the replay speed
+static void replayCallback(uint8_t *data, uint16_t len, uint32_t ts, uint64_t time_ns)
+{
+    handle_imu(data, len, ts, latency_now_ns(), time_ns);
+}
+
+// MCU callback from glasses
+static void mcuCallback(uint16_t msgid, uint8_t *data, uint16_t len, uint32_t ts)
+{
+    if (debug_mode) {
+        printf("MCU callback: msgid=%d len=%d\n", msgid, len);
+    }
+    // Could handle device events here
+}
+
+// Toggle head tracking on/off
+static void toggle_tracking(void)
+{
+    enabled = !enabled;
+    printf("Head tracking %s\n", enabled ? "enabled" : "disabled");
+    imu_power_set_active(&imu_power, enabled && !paused);
+    
+    if (!enabled) {
+        // Reset state when disabling
+        motion_emitter_reset(&emitter);
+    }
+}
+
+// Pause tracking temporarily
+static void pause_tracking(void) {
+    paused = true;
+    printf("Head tracking paused\n");
+    imu_power_set_active(&imu_power, false);
+}
+
+// Resume tracking
+static void resume_tracking(void) {
+    paused = false;
+    printf("Head tracking resumed\n");
+    imu_power_set_active(&imu_power, enabled);
+}
+
+// Recenter tracking
+static void recenter_tracking(void) {
+    motion_emitter_reset(&emitter);
+    printf("Position recentered. Hold still for a moment.\n");
+}
+
+// Hand the current config to the emitter thread (config_lock held). The
+// pipeline works per sample, so it is tuned to the rate the glasses actually
+// stream at, which the power manager lowers while the head is still.
+static void publish_config(void)
+{
+    if (output->prepare) {
+        output->prepare(&config);
+    }
+    
+    MouseConfig live = config;
+    if (imu_streaming) {
+        live.imu_rate = imu_power_rate(&imu_power);
+    }
+    motion_emitter_set_config(&emitter, &live);
+}
+
+// Power manager thread: the glasses changed rate
+static void imu_rate_changed(void)
+{
+    pthread_mutex_lock(&config_lock);
+    publish_config();
+    pthread_mutex_unlock(&config_lock);
+}
+
+// Reload configuration
+static void reload_configuration(void) {
+    pthread_mutex_lock(&config_lock);
+    
+    // Parse into a copy so a half-read file is never live
+    MouseConfig fresh = config;
+    if (config_file[0]) {
+        if (!load_config_file(config_file, &fresh)) {
+            fprintf(stderr, "Failed to load config from: %s\n", config_file);
+        }
+    } else {
+        load_config(&fresh);
+    }
+    config = fresh;
+    imu_power_configure(&imu_power, &config);
+    publish_config();
+    
+    pthread_mutex_unlock(&config_lock);
+    printf("Configuration reloaded\n");
+}
+
+// Get current tracking state
+static bool get_tracking_enabled(void) {
+    return enabled && !paused;
+}
+
+// Get current sensitivity
+static float get_current_sensitivity(void) {
+    return config.sensitivity_yaw;
+}
+
+// Set sensitivity
+static void set_current_sensitivity(float value) {
+    pthread_mutex_lock(&config_lock);
+    config.sensitivity_yaw = config.sensitivity_pitch = value;
+    publish_config();
+    pthread_mutex_unlock(&config_lock);
+    printf("Sensitivity set to %.1f\n", value);
+}
+
+// Adjust sensitivity
+static void adjust_current_sensitivity(float delta) {
+    pthread_mutex_lock(&config_lock);
+    float new_sens = config.sensitivity_yaw + delta;
+    if (new_sens > 0) {
+        set_current_sensitivity(new_sens);
+    }
+    pthread_mutex_unlock(&config_lock);
+}
+
+// Change any config setting by key, as written in the config file
+static bool set_config_option(const char *key, const char *value) {
+    pthread_mutex_lock(&config_lock);
+    if (!set_config_value(&config, key, value)) {
+        pthread_mutex_unlock(&config_lock);
+        return false;
+    }
+    imu_power_configure(&imu_power, &config);
+    publish_config();
+    pthread_mutex_unlock(&config_lock);
+    
+    if (strcmp(key, "absolute_mode") == 0) {
+        // Start absolute positioning from the current head direction
+        motion_emitter_reset(&emitter);
+    }
+    printf("%s set to %s\n", key, value);
+    return true;
+}
+
+// Get emitter, output and IMU power statistics
+static void get_emitter_stats(char *buffer, size_t size) {
+    char power[128];
+    imu_power_format_stats(&imu_power, power, sizeof(power));
+    
+    motion_emitter_format_stats(&emitter, buffer, size);
+    size_t used = strlen(buffer);
+    output->format_stats(buffer + used, size - used);
+    used = strlen(buffer);
+    snprintf(buffer + used, size - used, " %s", power);
+}
+
+// Get callback cost and end-to-end emission latency percentiles
+static void get_latency_report(char *buffer, size_t size) {
+    char callback[192], emit[192];
+    latency_histogram_format(&callback_latency, "callback", callback, sizeof(callback));
+    latency_histogram_format(&emitter.emit_latency, "emit", emit, sizeof(emit));
+    snprintf(buffer, size, "%s %s", callback, emit);
+}
+
+// Clear latency histograms
+static void reset_latency(void) {
+    latency_histogram_reset(&callback_latency);
+    latency_histogram_reset(&emitter.emit_latency);
+}
+
+// Interactive console - handle one command line, false on 'quit'
+static bool console_command(char *input_buffer)
+{
+    // Commands edit config directly, publish whatever they changed
+    pthread_mutex_lock(&config_lock);
+    if (strlen(input_buffer) == 0) {
+        toggle_tracking();
+    } else if (strcmp(input_buffer, "quit") == 0) {
+        printf("Exiting...\n");
+        pthread_mutex_unlock(&config_lock);
+        return false;
+    } else if (strncmp(input_buffer, "sens ", 5) == 0) {
+        float new_sens = atof(input_buffer + 5);
+        if (new_sens > 0) {
+            config.sensitivity_yaw = config.sensitivity_pitch = new_sens;
+            printf("Sensitivity set to %.2f\n", new_sens);
+        }
+    } else if (strncmp(input_buffer, "roll ", 5) == 0) {
+        float new_threshold = atof(input_buffer + 5);
+        if (new_threshold >= 0) {
+            config.roll_scroll_threshold = new_threshold;
+            printf("Roll scroll threshold set to %.2f degrees\n", new_threshold);
+        }
+    } else if (strncmp(input_buffer, "scroll ", 7) == 0) {
+        float new_speed = atof(input_buffer + 7);
+        if (new_speed > 0) {
+            set_config_value(&config, "scroll_speed", input_buffer + 7);
+            printf("Scroll speed set to %.1f lines/s at one degree past the threshold\n", config.scroll_speed);
+        }
+    } else if (strncmp(input_buffer, "smooth ", 7) == 0) {
+        float new_smooth = atof(input_buffer + 7);
+        if (new_smooth >= 0.0f && new_smooth <= 1.0f) {
+            set_config_value(&config, "smoothing", input_buffer + 7);
+            printf("Smoothing set to %.2f (%.1f ms time constant)\n", new_smooth, config.smoothing_ms);
+        }
+    } else if (strncmp(input_buffer, "deadzone ", 9) == 0) {
+        float new_deadzone = atof(input_buffer + 9);
+        if (new_deadzone >= 0.0f) {
+            set_config_value(&config, "deadzone_speed", input_buffer + 9);
+            printf("Deadzone set to %.2f degrees/second\n", config.deadzone_speed);
+        }
+    } else if (strncmp(input_buffer, "rate ", 5) == 0) {
+        if (!set_config_option("imu_rate", input_buffer + 5)) {
+            printf("Unsupported IMU rate '%s' (60, 90, 120 or 240)\n", input_buffer + 5);
+        }
+    } else if (strncmp(input_buffer, "output ", 7) == 0) {
+        if (!set_config_option("output_rate", input_buffer + 7)) {
+            printf("Invalid output rate '%s' (Hz, 0 = per IMU sample)\n", input_buffer + 7);
+        }
+    } else if (strncmp(input_buffer, "predict ", 8) == 0) {
+        float new_prediction = atof(input_buffer + 8);
+        if (new_prediction >= 0.0f && new_prediction <= 100.0f) {
+            config.prediction_ms = new_prediction;
+            printf("Prediction set to %.1f ms (0 = off)\n", new_prediction);
+        }
+    } else if (strncmp(input_buffer, "filter ", 7) == 0) {
+        if (!set_config_option("filter", input_buffer + 7)) {
+            printf("Unknown filter '%s' (legacy or one_euro)\n", input_buffer + 7);
+        }
+    } else if (strncmp(input_buffer, "set ", 4) == 0) {
+        char key[64], value[64];
+        if (sscanf(input_buffer + 4, "%63s %63s", key, value) != 2 ||
+            !set_config_option(key, value)) {
+            printf("Usage: set <config key> <value>\n");
+        }
+    } else if (strcmp(input_buffer, "invertx") == 0) {
+        config.invert_x = !config.invert_x;
+        printf("X-axis %s\n", config.invert_x ? "inverted" : "normal");
+    } else if (strcmp(input_buffer, "inverty") == 0) {
+        config.invert_y = !config.invert_y;
+        printf("Y-axis %s\n", config.invert_y ? "inverted" : "normal");
+    } else if (strcmp(input_buffer, "invertscroll") == 0) {
+        config.invert_scroll = !config.invert_scroll;
+        printf("Scroll direction %s\n", config.invert_scroll ? "inverted" : "normal");
+    } else if (strcmp(input_buffer, "absolute") == 0) {
+        config.absolute_mode = !config.absolute_mode;
+        motion_emitter_reset(&emitter);
+        printf("Positioning: %s\n", config.absolute_mode ? "absolute" : "relative");
+    } else if (strcmp(input_buffer, "quaternion") == 0) {
+        config.use_quaternion = !config.use_quaternion;
+        printf("Orientation source: %s\n", config.use_quaternion ? "quaternion" : "euler");
+    } else if (strcmp(input_buffer, "recenter") == 0) {
+        recenter_tracking();
+    } else if (strcmp(input_buffer, "status") == 0) {
+        // Print current configuration
+        printf("Current configuration:\n");
+        printf("  Sensitivity X/Y: %.1f/%.1f\n", config.sensitivity_yaw, config.sensitivity_pitch);
+        printf("  IMU rate: %d Hz\n", config.imu_rate);
+        if (imu_streaming) {
+            printf("  IMU stream: %s at %d Hz\n",
+                   imu_power_mode_name(atomic_load(&imu_power.mode)), imu_power_rate(&imu_power));
+        }
+        printf("  IMU while off: %s\n", config.disabled_imu == IMU_DISABLED_LOW ? "low rate" :
+               config.disabled_imu == IMU_DISABLED_FULL ? "full rate" : "stopped");
+        if (config.still_timeout_ms > 0) {
+            printf("  IMU while still: %d Hz after %d ms, full rate above %.1f degrees/second\n",
+                   IMU_POWER_LOW_RATE, config.still_timeout_ms, config.still_threshold);
+        } else {
+            printf("  IMU while still: full rate\n");
+        }
+        printf("  Smoothing: %.2f (%.1f ms time constant)\n",
+               legacy_smoothing_factor(config.smoothing_ms), config.smoothing_ms);
+        printf("  Filter: %s (min cutoff %.2f Hz, beta %.3f)\n",
+               config.filter == FILTER_ONE_EURO ? "one_euro" : "legacy",
+               config.euro_min_cutoff, config.euro_beta);
+        printf("  Deadzone: %.2f degrees/second\n", config.deadzone_speed);
+        printf("  Prediction: %.1f ms\n", config.prediction_ms);
+        if (config.output_rate > 0) {
+            printf("  Output rate: %d Hz\n", config.output_rate);
+        } else {
+            printf("  Output rate: per IMU sample\n");
+        }
+        printf("  Roll threshold: %.1f degrees (stops %.1f degrees below)\n",
+               config.roll_scroll_threshold, config.scroll_hysteresis);
+        printf("  Scroll speed: %.1f lines/s x degrees^%.2f, at most %.1f lines/s\n",
+               config.scroll_speed, config.scroll_curve, config.scroll_max_speed);
+        printf("  Scroll axis: %s\n", config.scroll_axis == SCROLL_HORIZONTAL ? "horizontal" : "vertical");
+        printf("  X-axis: %s\n", config.invert_x ? "inverted" : "normal");
+        printf("  Y-axis: %s\n", config.invert_y ? "inverted" : "normal");
+        printf("  Scroll: %s\n", config.invert_scroll ? "inverted" : "normal");
+        printf("  Orientation: %s\n", config.use_quaternion ? "quaternion" : "euler");
+        printf("  Positioning: %s (%.0fx%.0f degrees)\n",
+               config.absolute_mode ? "absolute" : "relative", config.yaw_range, config.pitch_range);
+    } else if (strcmp(input_buffer, "stats") == 0) {
+        char stats[512];
+        get_emitter_stats(stats, sizeof(stats));
+        printf("Emitter: %s\n", stats);
+    } else if (strcmp(input_buffer, "latency") == 0) {
+        char report[512];
+        get_latency_report(report, sizeof(report));
+        printf("Latency: %s\n", report);
+    } else if (strcmp(input_buffer, "latency reset") == 0) {
+        reset_latency();
+        printf("Latency histograms reset\n");
+    } else if (strcmp(input_buffer, "help") == 0) {
+        printf("Available commands:\n");
+        printf("  <Enter>         - Toggle head tracking on/off\n");
+        printf("  sens <float>    - Set sensitivity (e.g., sens 9.0)\n");
+        printf("  smooth <float>  - Set smoothing factor at 120 Hz (0.0-1.0)\n");
+        printf("  filter <mode>   - Set pose filter (legacy or one_euro)\n");
+        printf("  set <key> <val> - Set any config file key (e.g., set euro_beta 0.3)\n");
+        printf("  deadzone <float>- Set movement deadzone in degrees/second (any IMU rate)\n");
+        printf("  rate <hz>       - Set IMU sample rate (60, 90, 120 or 240)\n");
+        printf("  predict <ms>    - Set pose prediction horizon (0 = off)\n");
+        printf("  output <hz>     - Resample output to a fixed rate (0 = per IMU sample)\n");
+        printf("  roll <float>    - Set roll threshold for scrolling\n");
+        printf("  scroll <float>  - Set scroll speed in lines/s at one degree past the roll\n");
+        printf("                    threshold, shaped by scroll_curve, capped by scroll_max_speed\n");
+        printf("  invertx         - Toggle X-axis inversion\n");
+        printf("  inverty         - Toggle Y-axis inversion\n");
+        printf("  invertscroll    - Toggle scroll direction inversion\n");
+        printf("  quaternion      - Toggle quaternion (roll-compensated) orientation\n");
+        printf("  absolute        - Toggle absolute positioning (head direction = cursor)\n");
+        printf("  recenter        - Reset to current head orientation\n");
+        printf("  status          - Display current settings\n");
+        printf("  stats           - Display emitter queue and output statistics\n");
+        printf("  latency [reset] - Display (or reset) callback and emission latency\n");
+        printf("  save            - Save current settings to config file\n");
+        printf("  reload          - Reload settings from config file\n");
+        printf("  quit            - Exit the program\n");
+        printf("  debug           - Toggle debug output\n");
+        printf("  help            - Show this help\n");
+    } else if (strcmp(input_buffer, "debug") == 0) {
+        debug_mode = !debug_mode;
+        printf("Debug mode %s\n", debug_mode ? "enabled" : "disabled");
+    } else if (strcmp(input_buffer, "save") == 0) {
+        save_config(&config);
+    } else if (strcmp(input_buffer, "reload") == 0) {
+        reload_configuration();
+    } else {
+        printf("Unknown command. Type 'help' for available commands.\n");
+    }
+    publish_config();
+    pthread_mutex_unlock(&config_lock);
+    return true;
+}
+
+// Main thread: the console (unless running as a daemon) and signals, until
+// asked to stop
+static void run_main_loop(bool daemon_mode)
+{
+    EventLoop loop = {
+        .console = !daemon_mode,
+        .on_command = console_command,
+        .on_reload = reload_configuration,
+    };
+    if (daemon_mode) {
+        printf("Head mouse running as a daemon. Send SIGTERM to stop, SIGHUP to reload the config.\n");
+    } else {
+        printf("Head mouse control started. Press Enter to toggle on/off, type 'quit' to exit.\n");
+    }
+    event_loop_run(&loop);
+}
+
+// Connect to the glasses and start the IMU stream at the configured rate
+static bool start_imu(void)
+{
+    printf("Initializing Viture SDK...\n");
+    if (!init(imuCallback, mcuCallback)) {
+        fprintf(stderr, "Error: Failed to initialize Viture SDK\n");
+        return false;
+    }
+    
+    // Enable IMU data
+    printf("Enabling IMU data...\n");
+    int result = set_imu(true);
+    if (result != ERR_SUCCESS) {
+        fprintf(stderr, "Error: Failed to enable IMU data (error %d)\n", result);
+        deinit();
+        return false;
+    }
+    
+    // Set the IMU frequency and hand the stream to the power manager, which
+    // slows or stops it while nobody needs the full rate
+    pthread_mutex_lock(&config_lock);
+    imu_streaming = true;
+    imu_power.on_rate_change = imu_rate_changed;
+    if (!imu_power_start(&imu_power, &config, enabled && !paused)) {
+        fprintf(stderr, "Warning: IMU power saving disabled\n");
+    }
+    publish_config();
+    pthread_mutex_unlock(&config_lock);
+    return true;
+}
+
+// Drive the pipeline from a capture file instead of the glasses
+static bool run_replay(const char *path, double speed)
+{
+    struct timespec start, end;
+    
+    if (speed > 0.0) {
+        printf("Replaying %s at %.1fx speed...\n", path, speed);
+    } else {
+        printf("Replaying %s as fast as possible...\n", path);
+    }
+    
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    long count = imu_replay(path, speed, replayCallback);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    
+    if (count < 0) {
+        fprintf(stderr, "Error: Failed to replay %s\n", path);
+        return false;
+    }
+    
+    double elapsed = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+    printf("Replayed %ld samples in %.3f s (%.0f samples/s)\n",
+           count, elapsed, elapsed > 0.0 ? count / elapsed : 0.0);
+    return true;
+}
+
+static void print_usage(const char *prog_name) {
+    printf("Usage: %s [OPTIONS]\n", prog_name);
+    printf("Options:\n");
+    printf("  -d, --debug        Enable debug output\n");
+    printf("  -c, --config PATH  Load config from specified file\n");
+    printf("  -s, --save-config  Save current config to user config file\n");
+    printf("  -r, --record FILE  Record raw IMU data to a capture file\n");
+    printf("  -p, --replay FILE  Replay a capture file instead of using the glasses\n");
+    printf("  -x, --replay-speed N  Replay at N times the recorded pace (0 = as fast as possible)\n");
+    printf("  -D, --daemon       Run without the console; stop with SIGTERM, reload with SIGHUP\n");
+    printf("  -h, --help         Show this help message\n");
+}
+
+int daemon_main(int argc, char *argv[], const DaemonOutput *daemon_output)
+{
+    startup_ns = latency_now_ns();
+    output = daemon_output;
+    
+    // Parse command-line options
+    static struct option long_options[] = {
+        {"debug", no_argument, 0, 'd'},
+        {"config", required_argument, 0, 'c'},
+        {"save-config", no_argument, 0, 's'},
+        {"record", required_argument, 0, 'r'},
+        {"replay", required_argument, 0, 'p'},
+        {"replay-speed", required_argument, 0, 'x'},
+        {"daemon", no_argument, 0, 'D'},
+        {"help", no_argument, 0, 'h'},
+        {0, 0, 0, 0}
+    };
+    
+    char *config_path = NULL;
+    char *record_path = NULL;
+    char *replay_path = NULL;
+    double replay_speed = 1.0;
+    bool save_config_flag = false;
+    bool daemon_mode = false;
+    
+    int opt;
+    while ((opt = getopt_long(argc, argv, "dc:sr:p:x:Dh", long_options, NULL)) != -1) {
+        switch (opt) {
+            case 'd':
+                debug_mode = true;
+                printf("Debug mode enabled\n");
+                break;
+            case 'c':
+                config_path = optarg;
+                break;
+            case 's':
+                save_config_flag = true;
+                break;
+            case 'r':
+                record_path = optarg;
+                break;
+            case 'p':
+                replay_path = optarg;
+                break;
+            case 'x':
+                replay_speed = atof(optarg);
+                break;
+            case 'D':
+                daemon_mode = true;
+                break;
+            case 'h':
+                print_usage(argv[0]);
+                return 0;
+            default:
+                print_usage(argv[0]);
+                return 1;
+        }
+    }
+    
+    // Under systemd stdout goes to the journal, don't hold log lines back
+    if (daemon_mode) {
+        setvbuf(stdout, NULL, _IOLBF, 0);
+    }
+    
+    // Signals are read by the main loop; block them before any thread starts
+    // so none of them gets one. Replays keep the default handling.
+    if (!replay_path) {
+        event_loop_block_signals();
+    }
+    
+    // Console and socket commands may nest (e.g. "reload" from the console)
+    pthread_mutexattr_t lock_attr;
+    pthread_mutexattr_init(&lock_attr);
+    pthread_mutexattr_settype(&lock_attr, PTHREAD_MUTEX_RECURSIVE);
+    pthread_mutex_init(&config_lock, &lock_attr);
+    pthread_mutexattr_destroy(&lock_attr);
+    
+    // Load configuration
+    if (config_path) {
+        if (!load_config_file(config_path, &config)) {
+            fprintf(stderr, "Failed to load config from: %s\n", config_path);
+        }
+        snprintf(config_file, sizeof(config_file), "%s", config_path);
+    } else {
+        const char *loaded = load_config(&config);
+        if (loaded) {
+            snprintf(config_file, sizeof(config_file), "%s", loaded);
+        }
+    }
+    
+    // Save configuration if requested
+    if (save_config_flag) {
+        save_config(&config);
+        return 0;
+    }
+    
+    // Create the output before any thread can emit through it
+    if (!output->open(&config)) {
+        return 1;
+    }
+    
+    // Start the emitter thread that turns IMU samples into input events
+    publish_config();
+    emitter.emit = emit_output;
+    emitter.trace = trace_sample;
+    emitter.lossless = replay_path != NULL;
+    if (!motion_emitter_start(&emitter)) {
+        return 1;
+    }
+    
+    // Export the pose to shared memory before the first IMU packet can arrive
+    if (!pose_export_open(&pose_export)) {
+        fprintf(stderr, "Warning: Not exporting head pose to shared memory\n");
+    }
+    
+    // Start recording before the first IMU packet can arrive
+    if (record_path) {
+        if (!imu_capture_open(&capture, record_path)) {
+            fprintf(stderr, "Warning: Not recording IMU data\n");
+        } else {
+            recording = true;
+            printf("Recording IMU data to %s\n", record_path);
+        }
+    }
+    
+    // Initialize and start socket server
+    memset(&socket_server, 0, sizeof(socket_server));
+    socket_server.on_toggle = toggle_tracking;
+    socket_server.on_recenter = recenter_tracking;
+    socket_server.on_pause = pause_tracking;
+    socket_server.on_resume = resume_tracking;
+    socket_server.on_reload = reload_configuration;
+    socket_server.get_enabled = get_tracking_enabled;
+    socket_server.get_sensitivity = get_current_sensitivity;
+    socket_server.set_sensitivity = set_current_sensitivity;
+    socket_server.adjust_sensitivity = adjust_current_sensitivity;
+    socket_server.get_stats = get_emitter_stats;
+    socket_server.get_latency = get_latency_report;
+    socket_server.reset_latency = reset_latency;
+    socket_server.set_option = set_config_option;
+    
+    if (!start_socket_server(&socket_server)) {
+        fprintf(stderr, "Warning: Failed to start socket server\n");
+    }
+    
+    // Pick up config file edits as soon as they're saved
+    const char *watch_path = config_file[0] ? config_file : get_user_config_path();
+    config_watch.on_change = reload_configuration;
+    if (watch_path && config_watch_start(&config_watch, watch_path)) {
+        printf("Watching %s for changes\n", watch_path);
+    }
+    
+    // Connect to the glasses last, so the socket is already up and the
+    // output's startup overlaps SDK init (not needed when replaying a capture)
+    int exit_code = 0;
+    if (replay_path) {
+        // Replays are lossless, so don't start until the output is ready
+        if (output->wait_ready) {
+            output->wait_ready();
+        }
+        if (!run_replay(replay_path, replay_speed)) {
+            exit_code = 1;
+        }
+    } else if (start_imu()) {
+        run_main_loop(daemon_mode);
+    } else {
+        exit_code = 1;
+    }
+    
+    // Cleanup
+    config_watch_stop(&config_watch);
+    stop_socket_server(&socket_server);
+    if (imu_streaming) {
+        imu_power_stop(&imu_power);
+        set_imu(false);
+        deinit();
+    }
+    if (output->wait_ready) {
+        output->wait_ready();
+    }
+    motion_emitter_stop(&emitter);
+    if (recording) {
+        recording = false;
+        imu_capture_close(&capture);
+    }
+    pose_export_close(&pose_export);
+    output->close();
+    
+    return exit_code;
+}
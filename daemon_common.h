@@ -0,0 +1,43 @@
+#ifndef DAEMON_COMMON_H
+#define DAEMON_COMMON_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "mouse_config.h"
+#include "motion_pipeline.h"
+
+// Everything both daemons share: command-line options, the config and its
+// publishing to the emitter, the console and control socket, the IMU stream
+// and its power management, recording and replay, and the signal-driven main
+// loop. Each daemon only supplies the output that turns MotionOutput frames
+// into pointer events (XTest or uinput). Optional hooks may be NULL.
+typedef struct {
+    // Create the output for the initial config, before any other thread
+    // starts; false exits
+    bool (*open)(const MouseConfig *config);
+
+    // Control threads (config lock held): a config is about to be published
+    void (*prepare)(const MouseConfig *config);
+
+    // IMU thread: whether the output can take samples yet (NULL = always)
+    bool (*ready)(void);
+
+    // Block until the output is ready; called before a replay and at shutdown
+    void (*wait_ready)(void);
+
+    // Emitter thread: send one frame of (possibly coalesced) output. config
+    // is the emitter's published copy.
+    void (*emit)(const MotionOutput *out, const MouseConfig *config, bool debug);
+
+    // Append the output's counters to the stats line, starting with a space
+    void (*format_stats)(char *buffer, size_t size);
+
+    // Tear the output down once the emitter has stopped
+    void (*close)(void);
+} DaemonOutput;
+
+// Parse options, run until told to stop and clean up. Returns the exit code.
+int daemon_main(int argc, char *argv[], const DaemonOutput *output);
+
+#endif // DAEMON_COMMON_H
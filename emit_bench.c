@@ -0,0 +1,193 @@
+// Throughput of event emission: synthetic IMU packets are decoded, run
+// through the pipeline and written as uinput frames to a stand-in for the
+// uinput device, either /dev/null or a pipe drained by another thread.
+//
+// Two paths are measured for each signal:
+//   direct   decode, process and flush one frame per sample on one thread
+//   emitter  push samples through a lossless MotionEmitter, as the daemon does,
+//            which coalesces whatever queues up behind a write
+//
+// Usage: emit_bench [SAMPLES]
+// Prints one key=value line per signal, sink and path:
+//   bench=emit signal=slow_pan sink=pipe path=emitter samples=200000 samples_per_sec=... events_per_sec=... syscalls_per_sec=...
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <time.h>
+
+#include "motion_emitter.h"
+#include "uinput_frame.h"
+#include "imu_synth.h"
+
+#define DEFAULT_SAMPLES 200000
+#define RATE 120
+
+// Where frames are written, read by the emit callback
+static int sink_fd = -1;
+static MotionEmitter emitter;
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+// Same frame layout as the Wayland daemon's relative mode
+static void write_frame(const MotionOutput *out) {
+    UinputFrame frame;
+    uinput_frame_begin(&frame);
+    uinput_frame_add(&frame, EV_REL, REL_X, out->move_x);
+    uinput_frame_add(&frame, EV_REL, REL_Y, out->move_y);
+    uinput_frame_add(&frame, EV_REL, REL_WHEEL, out->scroll);
+    uinput_frame_add(&frame, EV_REL, REL_WHEEL_HI_RES, out->scroll_hires);
+    uinput_frame_flush(&frame, sink_fd);
+}
+
+// Reader end of the pipe sink
+static void* drain_pipe(void *arg) {
+    int fd = *(int *)arg;
+    char buffer[65536];
+    while (read(fd, buffer, sizeof(buffer)) > 0) {
+    }
+    return NULL;
+}
+
+static void run_direct(const MouseConfig *config, const uint8_t *packets, const uint32_t *ts,
+                       size_t count) {
+    MotionConfig prepared;
+    motion_config_prepare(&prepared, config);
+    MotionState state;
+    motion_state_reset(&state);
+
+    for (size_t i = 0; i < count; i++) {
+        MotionSample sample;
+        MotionOutput out;
+        motion_decode(packets + i * IMU_SYNTH_PACKET_SIZE, IMU_SYNTH_PACKET_SIZE, ts[i], &sample);
+        if (motion_process_prepared(&state, &prepared, &sample, &out)) {
+            write_frame(&out);
+        }
+    }
+}
+
+// Returns the number of samples coalesced into another sample's frame
+static unsigned long long run_emitter(const MouseConfig *config, const uint8_t *packets,
+                                      const uint32_t *ts, size_t count) {
+    motion_emitter_set_config(&emitter, config);
+    emitter.emit = write_frame;
+    emitter.lossless = true;
+    if (!motion_emitter_start(&emitter)) {
+        return 0;
+    }
+    unsigned long long coalesced = atomic_load(&emitter.coalesced);
+
+    for (size_t i = 0; i < count; i++) {
+        MotionSample sample;
+        motion_decode(packets + i * IMU_SYNTH_PACKET_SIZE, IMU_SYNTH_PACKET_SIZE, ts[i], &sample);
+        sample.arrival_ns = latency_now_ns();
+        motion_emitter_push(&emitter, &sample);
+    }
+    motion_emitter_stop(&emitter);
+
+    return atomic_load(&emitter.coalesced) - coalesced;
+}
+
+static void bench_path(const char *signal, const char *sink, bool through_emitter,
+                       const MouseConfig *config, const uint8_t *packets, const uint32_t *ts,
+                       size_t count) {
+    UinputFrameStats before, after;
+    unsigned long long coalesced = 0;
+
+    uinput_frame_get_stats(&before);
+    uint64_t start = now_ns();
+    if (through_emitter) {
+        coalesced = run_emitter(config, packets, ts, count);
+    } else {
+        run_direct(config, packets, ts, count);
+    }
+    double seconds = (now_ns() - start) / 1e9;
+    uinput_frame_get_stats(&after);
+
+    printf("bench=emit signal=%s sink=%s path=%s samples=%zu seconds=%.4f samples_per_sec=%.0f"
+           " frames_per_sec=%.0f events_per_sec=%.0f syscalls_per_sec=%.0f"
+           " events_per_syscall=%.2f coalesced=%llu errors=%llu\n",
+           signal, sink, through_emitter ? "emitter" : "direct", count, seconds, count / seconds,
+           (after.frames - before.frames) / seconds,
+           (after.events - before.events) / seconds,
+           (after.syscalls - before.syscalls) / seconds,
+           after.syscalls > before.syscalls ?
+               (double)(after.events - before.events) / (after.syscalls - before.syscalls) : 0.0,
+           coalesced,
+           (unsigned long long)(after.errors - before.errors));
+}
+
+int main(int argc, char *argv[]) {
+    size_t count = argc > 1 ? strtoul(argv[1], NULL, 10) : DEFAULT_SAMPLES;
+    if (count == 0) {
+        fprintf(stderr, "Usage: %s [SAMPLES]\n", argv[0]);
+        return 1;
+    }
+
+    uint8_t *packets = malloc(count * IMU_SYNTH_PACKET_SIZE);
+    uint32_t *ts = malloc(count * sizeof(uint32_t));
+    if (!packets || !ts) {
+        perror("Failed to allocate samples");
+        return 1;
+    }
+
+    int null_fd = open("/dev/null", O_WRONLY | O_CLOEXEC);
+    if (null_fd < 0) {
+        perror("Failed to open /dev/null");
+        return 1;
+    }
+    int pipe_fds[2];
+    if (pipe2(pipe_fds, O_CLOEXEC) < 0) {
+        perror("Failed to create pipe");
+        return 1;
+    }
+    pthread_t reader;
+    if (pthread_create(&reader, NULL, drain_pipe, &pipe_fds[0]) != 0) {
+        perror("Failed to create pipe reader");
+        return 1;
+    }
+
+    // Shipped defaults
+    MouseConfig config = {
+        .sensitivity_yaw = 45.0f,
+        .sensitivity_pitch = 45.0f,
+        .imu_rate = RATE,
+        .filter = FILTER_LEGACY,
+        .euro_min_cutoff = 1.0f,
+        .euro_beta = 0.2f,
+        .roll_scroll_threshold = 10.0f,
+        .scroll_hysteresis = 3.0f,
+        .scroll_speed = 12.0f,
+        .scroll_curve = 1.0f,
+        .scroll_max_speed = 40.0f,
+        .yaw_range = 60.0f,
+        .pitch_range = 40.0f,
+    };
+
+    for (int signal = 0; signal < IMU_SYNTH_COUNT; signal++) {
+        const char *name = imu_synth_name((ImuSynthSignal)signal);
+        imu_synth_generate((ImuSynthSignal)signal, RATE, packets, IMU_SYNTH_PACKET_SIZE, ts, count);
+
+        sink_fd = null_fd;
+        bench_path(name, "null", false, &config, packets, ts, count);
+        bench_path(name, "null", true, &config, packets, ts, count);
+        sink_fd = pipe_fds[1];
+        bench_path(name, "pipe", false, &config, packets, ts, count);
+        bench_path(name, "pipe", true, &config, packets, ts, count);
+    }
+
+    close(pipe_fds[1]);
+    pthread_join(reader, NULL);
+    close(pipe_fds[0]);
+    close(null_fd);
+    free(ts);
+    free(packets);
+    return 0;
+}
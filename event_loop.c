@@ -0,0 +1,133 @@
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <signal.h>
+#include <unistd.h>
+#include <poll.h>
+#include <sys/signalfd.h>
+
+#include "event_loop.h"
+
+// Longest console line, including the newline
+#define CONSOLE_LINE_MAX 256
+
+static void handled_signals(sigset_t *set) {
+    sigemptyset(set);
+    sigaddset(set, SIGTERM);
+    sigaddset(set, SIGINT);
+    sigaddset(set, SIGHUP);
+}
+
+bool event_loop_block_signals(void) {
+    sigset_t set;
+    handled_signals(&set);
+    if (sigprocmask(SIG_BLOCK, &set, NULL) < 0) {
+        perror("Failed to block signals");
+        return false;
+    }
+    return true;
+}
+
+// Handle pending signals; false if the loop should stop
+static bool read_signals(EventLoop *loop, int signal_fd) {
+    struct signalfd_siginfo info;
+    while (read(signal_fd, &info, sizeof(info)) == sizeof(info)) {
+        if (info.ssi_signo == SIGHUP) {
+            printf("SIGHUP received, reloading configuration\n");
+            if (loop->on_reload) loop->on_reload();
+        } else {
+            printf("%s received, exiting...\n", info.ssi_signo == SIGINT ? "SIGINT" : "SIGTERM");
+            return false;
+        }
+    }
+    return true;
+}
+
+// Read console input and run each complete line; false if a command quit
+static bool read_console(EventLoop *loop, char *buffer, size_t *used, bool *discarding) {
+    ssize_t n = read(STDIN_FILENO, buffer + *used, CONSOLE_LINE_MAX - *used);
+    if (n < 0 && (errno == EINTR || errno == EAGAIN)) {
+        return true;
+    }
+    if (n <= 0) {
+        // Run a last unterminated line, then stop polling stdin: from now on
+        // only signals stop us
+        loop->console = false;
+        if (*used > 0 && !*discarding) {
+            buffer[*used < CONSOLE_LINE_MAX ? *used : CONSOLE_LINE_MAX - 1] = '\0';
+            *used = 0;
+            if (!loop->on_command(buffer)) return false;
+        }
+        printf("Console closed, running until SIGTERM\n");
+        return true;
+    }
+    *used += n;
+
+    char *start = buffer;
+    char *newline;
+    while ((newline = memchr(start, '\n', buffer + *used - start))) {
+        *newline = '\0';
+        bool keep_going = *discarding || loop->on_command(start);
+        *discarding = false;
+        start = newline + 1;
+        if (!keep_going) return false;
+    }
+
+    *used = buffer + *used - start;
+    memmove(buffer, start, *used);
+    if (*used == CONSOLE_LINE_MAX) {
+        printf("Command too long, ignored\n");
+        *used = 0;
+        *discarding = true;
+    }
+    return true;
+}
+
+void event_loop_run(EventLoop *loop) {
+    sigset_t set;
+    handled_signals(&set);
+    int signal_fd = signalfd(-1, &set, SFD_NONBLOCK | SFD_CLOEXEC);
+    if (signal_fd < 0) {
+        // Let the signals kill us the default way instead
+        perror("Failed to create signalfd");
+        sigprocmask(SIG_UNBLOCK, &set, NULL);
+    }
+
+    char buffer[CONSOLE_LINE_MAX];
+    size_t used = 0;
+    bool discarding = false;    // Skipping the rest of an over-long line
+
+    bool running = true;
+    while (running) {
+        struct pollfd fds[2];
+        nfds_t count = 0;
+        if (signal_fd >= 0) {
+            fds[count++] = (struct pollfd){ .fd = signal_fd, .events = POLLIN };
+        }
+        if (loop->console) {
+            fds[count++] = (struct pollfd){ .fd = STDIN_FILENO, .events = POLLIN };
+        }
+        if (count == 0) {
+            // Nothing to wait on: only a signal ends the process now
+            pause();
+            continue;
+        }
+
+        if (poll(fds, count, -1) < 0) {
+            if (errno == EINTR) continue;
+            perror("Event loop poll failed");
+            break;
+        }
+
+        for (nfds_t i = 0; i < count && running; i++) {
+            if (!(fds[i].revents & (POLLIN | POLLHUP | POLLERR))) continue;
+            if (fds[i].fd == signal_fd) {
+                running = read_signals(loop, signal_fd);
+            } else {
+                running = read_console(loop, buffer, &used, &discarding);
+            }
+        }
+    }
+
+    if (signal_fd >= 0) close(signal_fd);
+}
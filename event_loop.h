@@ -0,0 +1,24 @@
+#ifndef EVENT_LOOP_H
+#define EVENT_LOOP_H
+
+#include <stdbool.h>
+
+// The daemons' main thread: sleeps in poll until a signal arrives (through a
+// signalfd) or, with the console enabled, a command line is typed on stdin.
+// SIGTERM and SIGINT stop the loop, SIGHUP calls on_reload. When stdin is
+// closed the console is dropped and the loop keeps waiting for signals, so a
+// daemon started without a terminal costs no CPU.
+typedef struct {
+    bool console;                   // Read commands from stdin
+    bool (*on_command)(char *line); // Console line without its newline; false quits
+    void (*on_reload)(void);        // SIGHUP
+} EventLoop;
+
+// Block the signals the loop handles. Call before starting any thread, so
+// every thread inherits the mask and they all arrive through the loop.
+bool event_loop_block_signals(void);
+
+// Run until a command asks to quit or a stop signal arrives
+void event_loop_run(EventLoop *loop);
+
+#endif // EVENT_LOOP_H
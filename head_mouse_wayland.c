@@ -1,74 +1,38 @@
 #include <stdio.h>
-#include <stdlib.h>
 #include <string.h>
 #include <stdint.h>
 #include <stdbool.h>
 #include <unistd.h>
-#include <math.h>
 #include <fcntl.h>
+#include <pthread.h>
+#include <stdatomic.h>
 #include <linux/uinput.h>
-#include <getopt.h>
 
-#include "viture.h"
-#include "mouse_config.h"
-#include "socket_server.h"
+#include "daemon_common.h"
+#include "latency_histogram.h"
+#include "uinput_frame.h"
+#include "uinput_ready.h"
 
-// Tracking state
-typedef struct {
-    float last_yaw;
-    float last_pitch;
-    float last_roll;
-    float last_dx;
-    float last_dy;
-    bool initialized;
-    
-    // Sub-pixel precision accumulators
-    float accum_x;              // Accumulator for sub-pixel X movement
-    float accum_y;              // Accumulator for sub-pixel Y movement
-    
-    // Absolute positioning vars
-    float center_yaw;           // Center yaw value for absolute positioning
-    float center_pitch;         // Center pitch value for absolute positioning
-} MouseState;
+// Longest wait for a new uinput device to show up (the fixed delay it replaced)
+#define UINPUT_READY_TIMEOUT_MS 1000
 
 // Global variables
 static int uinput_fd = -1;
-static MouseConfig config = {
-    .sensitivity_yaw = 45.0,    // Higher sensitivity for fixed-cursor feel
-    .sensitivity_pitch = 45.0,  // Higher sensitivity for fixed-cursor feel
-    .deadzone = 0.0,            // No deadzone for immediate response
-    .smoothing = 0.0,           // No smoothing for direct control
-    .roll_scroll_threshold = 20.0, // Degrees of roll to trigger scrolling
-    .scroll_sensitivity = 0.1,  // Scroll sensitivity
-    .invert_x = false,
-    .invert_y = true,           // Inverted Y for natural movement
-    .invert_scroll = false,
-    .yaw_range = 40.0,          // 40 degrees yaw covers screen width
-    .pitch_range = 25.0         // 25 degrees pitch covers screen height
-};
-static MouseState state = {
-    .initialized = false
-};
-static bool enabled = true;
-static bool paused = false;
-static bool debug_mode = false;
-static SocketServer socket_server;
+static bool uinput_absolute = false;    // Device was created for absolute positioning
+static bool uinput_wanted_absolute;     // Mode of the newest device (control threads)
+static atomic_int uinput_pending = -1;  // Replacement device for the emitter, fd << 1 | absolute
+static atomic_bool uinput_ready;        // The compositor can see the device, IMU samples flow
+static pthread_t uinput_ready_thread;
+static bool uinput_waiting = false;     // uinput_ready_thread still to be joined
+static pthread_mutex_t uinput_switch_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t uinput_switch_done = PTHREAD_COND_INITIALIZER;
+static int uinput_newest = -1;          // Newest mode-switch device, fd << 1 | absolute
+static int uinput_switches = 0;         // Switch threads still waiting for their device
 
-// Convert byte array to float (from SDK example)
-static float makeFloat(uint8_t *data)
-{
-    float value = 0;
-    uint8_t tem[4];
-    tem[0] = data[3];
-    tem[1] = data[2];
-    tem[2] = data[1];
-    tem[3] = data[0];
-    memcpy(&value, tem, 4);
-    return value;
-}
-
-// Set up the uinput virtual mouse device
-static int setup_uinput_device()
+// Set up the uinput virtual mouse device. In absolute mode it reports
+// ABS_X/ABS_Y like a VM tablet, so the compositor maps positions straight to
+// the screen with no pointer acceleration.
+static int setup_uinput_device(bool absolute)
 {
     struct uinput_setup usetup;
     int fd = open("/dev/uinput", O_WRONLY | O_NONBLOCK);
@@ -79,12 +43,20 @@ static int setup_uinput_device()
 
     // Enable mouse movement events
     ioctl(fd, UI_SET_EVBIT, EV_REL);
-    ioctl(fd, UI_SET_RELBIT, REL_X);
-    ioctl(fd, UI_SET_RELBIT, REL_Y);
+    if (absolute) {
+        ioctl(fd, UI_SET_EVBIT, EV_ABS);
+        ioctl(fd, UI_SET_ABSBIT, ABS_X);
+        ioctl(fd, UI_SET_ABSBIT, ABS_Y);
+    } else {
+        ioctl(fd, UI_SET_RELBIT, REL_X);
+        ioctl(fd, UI_SET_RELBIT, REL_Y);
+    }
     
-    // Enable scroll wheel events
+    // Enable scroll wheel events, with high-resolution scrolling
     ioctl(fd, UI_SET_RELBIT, REL_WHEEL);
     ioctl(fd, UI_SET_RELBIT, REL_HWHEEL); // Horizontal wheel
+    ioctl(fd, UI_SET_RELBIT, REL_WHEEL_HI_RES);
+    ioctl(fd, UI_SET_RELBIT, REL_HWHEEL_HI_RES);
     
     // Enable mouse buttons
     ioctl(fd, UI_SET_EVBIT, EV_KEY);
@@ -105,480 +77,241 @@ static int setup_uinput_device()
         return -1;
     }
 
+    // Absolute axes span the pipeline's position range
+    for (int axis = ABS_X; absolute && axis <= ABS_Y; axis++) {
+        struct uinput_abs_setup abs_setup;
+        memset(&abs_setup, 0, sizeof(abs_setup));
+        abs_setup.code = axis;
+        abs_setup.absinfo.minimum = 0;
+        abs_setup.absinfo.maximum = MOTION_ABS_MAX;
+        if (ioctl(fd, UI_ABS_SETUP, &abs_setup) < 0) {
+            perror("Error setting up absolute axes");
+            close(fd);
+            return -1;
+        }
+    }
+
     if (ioctl(fd, UI_DEV_CREATE) < 0) {
         perror("Error creating uinput device");
         close(fd);
         return -1;
     }
 
-    // Wait for device to be fully created
-    sleep(1);
+    // Not usable until wait_uinput_device returns
     return fd;
 }
 
-// Send mouse movement events to uinput
-void emit_mouse_movement(int fd, int dx, int dy)
+// Wait until the compositor can see a new device
+static void wait_uinput_device(int fd)
 {
-    struct input_event ev;
-    memset(&ev, 0, sizeof(ev));
-    
-    // Send X movement
-    if (dx != 0) {
-        ev.type = EV_REL;
-        ev.code = REL_X;
-        ev.value = dx;
-        write(fd, &ev, sizeof(ev));
-    }
-    
-    // Send Y movement
-    if (dy != 0) {
-        ev.type = EV_REL;
-        ev.code = REL_Y;
-        ev.value = dy;
-        write(fd, &ev, sizeof(ev));
+    char node[64];
+    uint64_t start = latency_now_ns();
+    if (uinput_wait_ready(fd, UINPUT_READY_TIMEOUT_MS, node, sizeof(node))) {
+        printf("Virtual input device %s ready after %.1f ms\n", node, (latency_now_ns() - start) / 1e6);
+    } else {
+        fprintf(stderr, "Warning: Virtual input device not seen after %d ms, using it anyway\n",
+                UINPUT_READY_TIMEOUT_MS);
     }
-    
-    // Send sync event
-    ev.type = EV_SYN;
-    ev.code = SYN_REPORT;
-    ev.value = 0;
-    write(fd, &ev, sizeof(ev));
 }
 
-// Send scroll wheel events to uinput
-void emit_scroll(int fd, int amount, bool horizontal)
+// Startup: let IMU samples through once the first device is ready
+static void* wait_uinput_thread(void *arg)
 {
-    struct input_event ev;
-    memset(&ev, 0, sizeof(ev));
-    
-    // Send scroll event
-    ev.type = EV_REL;
-    ev.code = horizontal ? REL_HWHEEL : REL_WHEEL;
-    ev.value = amount;
-    write(fd, &ev, sizeof(ev));
-    
-    // Send sync event
-    ev.type = EV_SYN;
-    ev.code = SYN_REPORT;
-    ev.value = 0;
-    write(fd, &ev, sizeof(ev));
+    wait_uinput_device((int)(intptr_t)arg);
+    atomic_store(&uinput_ready, true);
+    return NULL;
 }
 
-// IMU data callback from glasses
-static void imuCallback(uint8_t *data, uint16_t len, uint32_t ts)
+// Drop a replacement device nobody is going to use
+static void destroy_uinput_device(int packed)
 {
-    if (!enabled || paused || uinput_fd < 0) return;
-    
-    // Extract Euler angles
-    float roll = makeFloat(data);
-    float pitch = makeFloat(data + 4);
-    float yaw = makeFloat(data + 8);
-    
-    // Debug output
-    if (debug_mode) {
-        printf("IMU: roll=%f pitch=%f yaw=%f\n", roll, pitch, yaw);
+    ioctl(packed >> 1, UI_DEV_DESTROY);
+    close(packed >> 1);
+}
+
+// Switch thread: hand a ready device to the emitter, unless a newer switch
+// has replaced it while it was showing up
+static void finish_uinput_switch(int packed)
+{
+    pthread_mutex_lock(&uinput_switch_lock);
+    if (packed == uinput_newest) {
+        // A device for the mode before that the emitter never got to is ours to drop
+        int stale = atomic_exchange(&uinput_pending, packed);
+        if (stale >= 0) destroy_uinput_device(stale);
+    } else {
+        destroy_uinput_device(packed);
     }
+    pthread_mutex_unlock(&uinput_switch_lock);
+}
+
+// Mode switch: wait for the new device, then hand it over
+static void* switch_uinput_thread(void *arg)
+{
+    int packed = (int)(intptr_t)arg;
+    wait_uinput_device(packed >> 1);
+    finish_uinput_switch(packed);
+    
+    pthread_mutex_lock(&uinput_switch_lock);
+    uinput_switches--;
+    pthread_cond_broadcast(&uinput_switch_done);
+    pthread_mutex_unlock(&uinput_switch_lock);
+    return NULL;
+}
+
+// Control thread (config_lock held): build a device for a new positioning
+// mode. Waiting for it to show up happens on a switch thread so the lock is
+// not held for it; the emitter keeps using the old device until then.
+static void prepare_uinput_device(const MouseConfig *config)
+{
+    bool absolute = config->absolute_mode;
+    if (absolute == uinput_wanted_absolute) return;
     
-    // Initialize reference position if needed
-    if (!state.initialized) {
-        state.last_yaw = yaw;
-        state.last_pitch = pitch;
-        state.last_roll = roll;
-        state.center_yaw = yaw;      // Store center position
-        state.center_pitch = pitch;  // Store center position
-        state.accum_x = 0.0f;
-        state.accum_y = 0.0f;
-        state.initialized = true;
+    printf("Switching to %s positioning...\n", absolute ? "absolute" : "relative");
+    int fd = setup_uinput_device(absolute);
+    if (fd < 0) {
+        fprintf(stderr, "Failed to recreate virtual input device\n");
         return;
     }
+    uinput_wanted_absolute = absolute;
+    int packed = fd << 1 | absolute;
     
-    // ---- MOUSE MOVEMENT CONTROL ----
-    
-    // Quaternion data for more accurate orientation (if available)
-    float quaternionW = 0.0f, quaternionX = 0.0f, quaternionY = 0.0f, quaternionZ = 0.0f;
-    bool have_quaternion = false;
-    
-    if (len >= 36) {
-        quaternionW = makeFloat(data + 20);
-        quaternionX = makeFloat(data + 24);
-        quaternionY = makeFloat(data + 28);
-        quaternionZ = makeFloat(data + 32);
-        have_quaternion = true;
-    }
-    
-    // Calculate relative movement
-    float delta_yaw = yaw - state.last_yaw;
-    float delta_pitch = pitch - state.last_pitch;
-    
-    // Handle angle wrap-around (yaw goes from -180 to 180)
-    if (delta_yaw > 180.0f) delta_yaw -= 360.0f;
-    if (delta_yaw < -180.0f) delta_yaw += 360.0f;
+    pthread_mutex_lock(&uinput_switch_lock);
+    uinput_newest = packed;
+    uinput_switches++;
+    pthread_mutex_unlock(&uinput_switch_lock);
     
-    // Apply dead zone with smooth transition
-    if (fabs(delta_yaw) < config.deadzone) {
-        delta_yaw = 0.0f;
+    pthread_t thread;
+    if (pthread_create(&thread, NULL, switch_uinput_thread, (void *)(intptr_t)packed) == 0) {
+        pthread_detach(thread);
     } else {
-        // Smooth transition from deadzone
-        float sign = delta_yaw > 0 ? 1.0f : -1.0f;
-        delta_yaw = sign * (fabs(delta_yaw) - config.deadzone);
-    }
-    
-    if (fabs(delta_pitch) < config.deadzone) {
-        delta_pitch = 0.0f;
-    } else {
-        // Smooth transition from deadzone
-        float sign = delta_pitch > 0 ? 1.0f : -1.0f;
-        delta_pitch = sign * (fabs(delta_pitch) - config.deadzone);
-    }
-    
-    // Apply sensitivity - more responsive with higher values
-    float dx = delta_yaw * config.sensitivity_yaw;
-    float dy = delta_pitch * config.sensitivity_pitch;
-    
-    // Apply inversion if configured
-    if (config.invert_x) dx = -dx;
-    if (config.invert_y) dy = -dy;
-    
-    // Apply smoothing
-    dx = dx * (1.0f - config.smoothing) + state.last_dx * config.smoothing;
-    dy = dy * (1.0f - config.smoothing) + state.last_dy * config.smoothing;
-    
-    // Add to sub-pixel accumulators
-    state.accum_x += dx;
-    state.accum_y += dy;
-    
-    // Extract integer pixel movement
-    int move_x = (int)state.accum_x;
-    int move_y = (int)state.accum_y;
-    
-    // Keep sub-pixel remainder
-    state.accum_x -= move_x;
-    state.accum_y -= move_y;
-    
-    // Move the mouse cursor if there's movement
-    if (move_x != 0 || move_y != 0) {
-        emit_mouse_movement(uinput_fd, move_x, move_y);
-    }
-    
-    // ---- SCROLL WHEEL CONTROL ----
-    
-    // Check if roll exceeds threshold for scrolling
-    float abs_roll = fabs(roll);
-    if (abs_roll > config.roll_scroll_threshold) {
-        // Calculate scroll amount based on how far past threshold
-        float scroll_amount = (abs_roll - config.roll_scroll_threshold) * config.scroll_sensitivity;
-        
-        // Determine scroll direction
-        int scroll_value = (int)scroll_amount;
-        if (scroll_value > 0) {
-            // Set direction based on roll and inversion setting
-            if (roll > 0) {
-                scroll_value = config.invert_scroll ? -scroll_value : scroll_value;
-            } else {
-                scroll_value = config.invert_scroll ? scroll_value : -scroll_value;
-            }
-            
-            // Send scroll event
-            emit_scroll(uinput_fd, scroll_value, false); // false for vertical scrolling
-            if (debug_mode) {
-                printf("Scrolling: amount=%d\n", scroll_value);
-            }
-        }
+        switch_uinput_thread((void *)(intptr_t)packed);
     }
-    
-    // Update state for next iteration
-    state.last_yaw = yaw;
-    state.last_pitch = pitch;
-    state.last_roll = roll;
-    state.last_dx = dx;
-    state.last_dy = dy;
 }
 
-// MCU callback from glasses
-static void mcuCallback(uint16_t msgid, uint8_t *data, uint16_t len, uint32_t ts)
+// Emitter thread: switch to a device prepared for the other positioning mode.
+// The new device is ready before the old one goes away so the cursor is never
+// without one.
+static void adopt_uinput_device(void)
 {
-    if (debug_mode) {
-        printf("MCU callback: msgid=%d len=%d\n", msgid, len);
+    int pending = atomic_exchange(&uinput_pending, -1);
+    if (pending < 0) return;
+    
+    int old_fd = uinput_fd;
+    uinput_fd = pending >> 1;
+    uinput_absolute = pending & 1;
+    if (old_fd >= 0) {
+        ioctl(old_fd, UI_DEV_DESTROY);
+        close(old_fd);
     }
-    // Could handle device events here
 }
 
-// Toggle head tracking on/off
-void toggle_tracking()
+// Emitter thread: send one frame of (possibly coalesced) output.
+// Motion and scroll go out together as a single evdev frame.
+static void emit_output(const MotionOutput *out, const MouseConfig *config, bool debug)
 {
-    enabled = !enabled;
-    printf("Head tracking %s\n", enabled ? "enabled" : "disabled");
+    if (atomic_load_explicit(&uinput_pending, memory_order_relaxed) >= 0) {
+        adopt_uinput_device();
+    }
     
-    if (!enabled) {
-        // Reset state when disabling
-        state.initialized = false;
+    UinputFrame frame;
+    uinput_frame_begin(&frame);
+    if (out->absolute && uinput_absolute) {
+        uinput_frame_add(&frame, EV_ABS, ABS_X, out->abs_x);
+        uinput_frame_add(&frame, EV_ABS, ABS_Y, out->abs_y);
+    } else if (!uinput_absolute) {
+        uinput_frame_add(&frame, EV_REL, REL_X, out->move_x);
+        uinput_frame_add(&frame, EV_REL, REL_Y, out->move_y);
+    }
+    
+    // High-resolution units go out as they build up, whole clicks for
+    // clients that only read the plain wheel
+    if (config->scroll_axis == SCROLL_HORIZONTAL) {
+        uinput_frame_add(&frame, EV_REL, REL_HWHEEL, out->scroll);
+        uinput_frame_add(&frame, EV_REL, REL_HWHEEL_HI_RES, out->scroll_hires);
+    } else {
+        uinput_frame_add(&frame, EV_REL, REL_WHEEL, out->scroll);
+        uinput_frame_add(&frame, EV_REL, REL_WHEEL_HI_RES, out->scroll_hires);
+    }
+    uinput_frame_flush(&frame, uinput_fd);
+    
+    if (out->scroll_hires != 0 && debug) {
+        printf("Scrolling: amount=%d/%d clicks=%d\n", out->scroll_hires, MOTION_SCROLL_HIRES, out->scroll);
     }
 }
 
-// Pause tracking temporarily
-void pause_tracking() {
-    paused = true;
-    printf("Head tracking paused\n");
-}
-
-// Resume tracking
-void resume_tracking() {
-    paused = false;
-    printf("Head tracking resumed\n");
-}
-
-// Recenter tracking
-void recenter_tracking() {
-    state.initialized = false;
-    printf("Position recentered. Hold still for a moment.\n");
-}
-
-// Reload configuration
-void reload_configuration() {
-    load_config(&config);
-    printf("Configuration reloaded\n");
-}
-
-// Get current tracking state
-bool get_tracking_enabled() {
-    return enabled && !paused;
-}
-
-// Get current sensitivity
-float get_current_sensitivity() {
-    return config.sensitivity_yaw;
-}
-
-// Set sensitivity
-void set_current_sensitivity(float value) {
-    config.sensitivity_yaw = config.sensitivity_pitch = value;
-    printf("Sensitivity set to %.1f\n", value);
-}
-
-// Adjust sensitivity
-void adjust_current_sensitivity(float delta) {
-    float new_sens = config.sensitivity_yaw + delta;
-    if (new_sens > 0) {
-        set_current_sensitivity(new_sens);
-    }
+// Get uinput statistics
+static void format_uinput_stats(char *buffer, size_t size)
+{
+    UinputFrameStats frames;
+    uinput_frame_get_stats(&frames);
+    snprintf(buffer, size, " frames=%llu events=%llu syscalls=%llu write_errors=%llu",
+             (unsigned long long)frames.frames, (unsigned long long)frames.events,
+             (unsigned long long)frames.syscalls, (unsigned long long)frames.errors);
 }
 
-void print_usage(const char *prog_name) {
-    printf("Usage: %s [OPTIONS]\n", prog_name);
-    printf("Options:\n");
-    printf("  -d, --debug        Enable debug output\n");
-    printf("  -c, --config PATH  Load config from specified file\n");
-    printf("  -s, --save-config  Save current config to user config file\n");
-    printf("  -h, --help         Show this help message\n");
+// IMU thread: hold samples back until the first device is ready
+static bool uinput_device_ready(void)
+{
+    return atomic_load(&uinput_ready);
 }
 
-int main(int argc, char *argv[])
+// Initialize the virtual input device
+static bool open_uinput(const MouseConfig *config)
 {
-    // Parse command-line options
-    static struct option long_options[] = {
-        {"debug", no_argument, 0, 'd'},
-        {"config", required_argument, 0, 'c'},
-        {"save-config", no_argument, 0, 's'},
-        {"help", no_argument, 0, 'h'},
-        {0, 0, 0, 0}
-    };
-    
-    char *config_path = NULL;
-    bool save_config_flag = false;
-    
-    int opt;
-    while ((opt = getopt_long(argc, argv, "dc:sh", long_options, NULL)) != -1) {
-        switch (opt) {
-            case 'd':
-                debug_mode = true;
-                printf("Debug mode enabled\n");
-                break;
-            case 'c':
-                config_path = optarg;
-                break;
-            case 's':
-                save_config_flag = true;
-                break;
-            case 'h':
-                print_usage(argv[0]);
-                return 0;
-            default:
-                print_usage(argv[0]);
-                return 1;
-        }
-    }
-    
-    // Load configuration
-    if (config_path) {
-        if (!load_config_file(config_path, &config)) {
-            fprintf(stderr, "Failed to load config from: %s\n", config_path);
-        }
-    } else {
-        load_config(&config);
-    }
-    
-    // Save configuration if requested
-    if (save_config_flag) {
-        save_config(&config);
-        return 0;
-    }
-    // Initialize virtual input device
     printf("Setting up virtual input device...\n");
-    uinput_fd = setup_uinput_device();
+    uinput_fd = setup_uinput_device(config->absolute_mode);
+    uinput_absolute = uinput_wanted_absolute = config->absolute_mode;
     if (uinput_fd < 0) {
         fprintf(stderr, "Failed to create virtual input device. Are you running as root?\n");
-        return 1;
+        return false;
     }
     
-    // Initialize Viture SDK
-    printf("Initializing Viture SDK...\n");
-    if (!init(imuCallback, mcuCallback)) {
-        fprintf(stderr, "Error: Failed to initialize Viture SDK\n");
-        ioctl(uinput_fd, UI_DEV_DESTROY);
-        close(uinput_fd);
-        return 1;
-    }
-    
-    // Enable IMU data
-    printf("Enabling IMU data...\n");
-    int result = set_imu(true);
-    if (result != ERR_SUCCESS) {
-        fprintf(stderr, "Error: Failed to enable IMU data (error %d)\n", result);
-        deinit();
-        ioctl(uinput_fd, UI_DEV_DESTROY);
-        close(uinput_fd);
-        return 1;
+    // The device takes a while to show up; wait for it in the background
+    // while everything else starts, holding IMU samples back until then
+    uinput_waiting = pthread_create(&uinput_ready_thread, NULL, wait_uinput_thread,
+                                    (void *)(intptr_t)uinput_fd) == 0;
+    if (!uinput_waiting) {
+        wait_uinput_device(uinput_fd);
+        atomic_store(&uinput_ready, true);
     }
-    
-    // Set IMU frequency to 120Hz for smoother tracking
-    set_imu_fq(IMU_FREQUENCE_120);
-    
-    // Initialize and start socket server
-    memset(&socket_server, 0, sizeof(socket_server));
-    socket_server.on_toggle = toggle_tracking;
-    socket_server.on_recenter = recenter_tracking;
-    socket_server.on_pause = pause_tracking;
-    socket_server.on_resume = resume_tracking;
-    socket_server.on_reload = reload_configuration;
-    socket_server.get_enabled = get_tracking_enabled;
-    socket_server.get_sensitivity = get_current_sensitivity;
-    socket_server.set_sensitivity = set_current_sensitivity;
-    socket_server.adjust_sensitivity = adjust_current_sensitivity;
-    
-    if (!start_socket_server(&socket_server)) {
-        fprintf(stderr, "Warning: Failed to start socket server\n");
+    return true;
+}
+
+// Wait for the startup device and any mode switch in flight to finish
+static void wait_uinput_ready(void)
+{
+    if (uinput_waiting) {
+        pthread_join(uinput_ready_thread, NULL);
+        uinput_waiting = false;
     }
     
-    printf("Head mouse control started. Press Enter to toggle on/off, type 'quit' to exit.\n");
-    
-    // Main loop - handle user commands
-    char input_buffer[256];
-    while (1) {
-        if (fgets(input_buffer, sizeof(input_buffer), stdin) != NULL) {
-            // Remove newline if present
-            size_t len = strlen(input_buffer);
-            if (len > 0 && input_buffer[len-1] == '\n') {
-                input_buffer[len-1] = '\0';
-            }
-            
-            if (strlen(input_buffer) == 0) {
-                toggle_tracking();
-            } else if (strcmp(input_buffer, "quit") == 0) {
-                printf("Exiting...\n");
-                break;
-            } else if (strncmp(input_buffer, "sens ", 5) == 0) {
-                float new_sens = atof(input_buffer + 5);
-                if (new_sens > 0) {
-                    config.sensitivity_yaw = config.sensitivity_pitch = new_sens;
-                    printf("Sensitivity set to %.2f\n", new_sens);
-                }
-            } else if (strncmp(input_buffer, "roll ", 5) == 0) {
-                float new_threshold = atof(input_buffer + 5);
-                if (new_threshold >= 0) {
-                    config.roll_scroll_threshold = new_threshold;
-                    printf("Roll scroll threshold set to %.2f degrees\n", new_threshold);
-                }
-            } else if (strncmp(input_buffer, "scroll ", 7) == 0) {
-               float new_sens = atof(input_buffer + 7);
-               if (new_sens > 0) {
-                   config.scroll_sensitivity = new_sens;
-                   printf("Scroll sensitivity set to %.2f\n", new_sens);
-               }
-           } else if (strncmp(input_buffer, "smooth ", 7) == 0) {
-               float new_smooth = atof(input_buffer + 7);
-               if (new_smooth >= 0.0f && new_smooth <= 1.0f) {
-                   config.smoothing = new_smooth;
-                   printf("Smoothing set to %.2f (0.0 = no smoothing, 1.0 = max smoothing)\n", new_smooth);
-               }
-           } else if (strncmp(input_buffer, "deadzone ", 9) == 0) {
-               float new_deadzone = atof(input_buffer + 9);
-               if (new_deadzone >= 0.0f) {
-                   config.deadzone = new_deadzone;
-                   printf("Deadzone set to %.2f degrees\n", new_deadzone);
-               }
-           } else if (strcmp(input_buffer, "invertx") == 0) {
-               config.invert_x = !config.invert_x;
-               printf("X-axis %s\n", config.invert_x ? "inverted" : "normal");
-           } else if (strcmp(input_buffer, "inverty") == 0) {
-               config.invert_y = !config.invert_y;
-               printf("Y-axis %s\n", config.invert_y ? "inverted" : "normal");
-           } else if (strcmp(input_buffer, "invertscroll") == 0) {
-               config.invert_scroll = !config.invert_scroll;
-               printf("Scroll direction %s\n", config.invert_scroll ? "inverted" : "normal");
-           } else if (strcmp(input_buffer, "recenter") == 0) {
-               recenter_tracking();
-           } else if (strcmp(input_buffer, "status") == 0) {
-               // Print current configuration
-               printf("Current configuration:\n");
-               printf("  Sensitivity X/Y: %.1f/%.1f\n", config.sensitivity_yaw, config.sensitivity_pitch);
-               printf("  Smoothing: %.2f\n", config.smoothing);
-               printf("  Deadzone: %.2f degrees\n", config.deadzone);
-               printf("  Roll threshold: %.1f degrees\n", config.roll_scroll_threshold);
-               printf("  Scroll sensitivity: %.2f\n", config.scroll_sensitivity);
-               printf("  X-axis: %s\n", config.invert_x ? "inverted" : "normal");
-               printf("  Y-axis: %s\n", config.invert_y ? "inverted" : "normal");
-               printf("  Scroll: %s\n", config.invert_scroll ? "inverted" : "normal");
-           } else if (strcmp(input_buffer, "help") == 0) {
-               printf("Available commands:\n");
-               printf("  <Enter>         - Toggle head tracking on/off\n");
-               printf("  sens <float>    - Set sensitivity (e.g., sens 9.0)\n");
-               printf("  smooth <float>  - Set smoothing factor (0.0-1.0)\n");
-               printf("  deadzone <float>- Set movement deadzone in degrees\n");
-               printf("  roll <float>    - Set roll threshold for scrolling\n");
-               printf("  scroll <float>  - Set scroll sensitivity\n");
-               printf("  invertx         - Toggle X-axis inversion\n");
-               printf("  inverty         - Toggle Y-axis inversion\n");
-               printf("  invertscroll    - Toggle scroll direction inversion\n");
-               printf("  recenter        - Reset to current head orientation\n");
-               printf("  status          - Display current settings\n");
-               printf("  save            - Save current settings to config file\n");
-               printf("  reload          - Reload settings from config file\n");
-               printf("  quit            - Exit the program\n");
-               printf("  debug           - Toggle debug output\n");
-               printf("  help            - Show this help\n");
-           } else if (strcmp(input_buffer, "debug") == 0) {
-               debug_mode = !debug_mode;
-               printf("Debug mode %s\n", debug_mode ? "enabled" : "disabled");
-           } else if (strcmp(input_buffer, "save") == 0) {
-               save_config(&config);
-           } else if (strcmp(input_buffer, "reload") == 0) {
-               reload_configuration();
-           } else {
-               printf("Unknown command. Type 'help' for available commands.\n");
-           }
-        }
+    pthread_mutex_lock(&uinput_switch_lock);
+    while (uinput_switches > 0) {
+        pthread_cond_wait(&uinput_switch_done, &uinput_switch_lock);
     }
-    
-    // Cleanup
-    stop_socket_server(&socket_server);
-    set_imu(false);
-    deinit();
-    
-    // Destroy virtual input device
+    pthread_mutex_unlock(&uinput_switch_lock);
+}
+
+// Destroy virtual input device, and a replacement the emitter never took
+static void close_uinput(void)
+{
+    adopt_uinput_device();
     if (uinput_fd >= 0) {
         ioctl(uinput_fd, UI_DEV_DESTROY);
         close(uinput_fd);
     }
-    
-    return 0;
-}
\ No newline at end of file
+}
+
+int main(int argc, char *argv[])
+{
+    static const DaemonOutput output = {
+        .open = open_uinput,
+        .prepare = prepare_uinput_device,
+        .ready = uinput_device_ready,
+        .wait_ready = wait_uinput_ready,
+        .emit = emit_output,
+        .format_stats = format_uinput_stats,
+        .close = close_uinput,
+    };
+    return daemon_main(argc, argv, &output);
+}
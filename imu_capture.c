@@ -0,0 +1,225 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <time.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "imu_capture.h"
+
+// Capture files grow by this much whenever the mapping fills up
+#define CAPTURE_GROW_SIZE (1024 * 1024)
+
+#define RECORD_ALIGN 8
+#define ALIGN_UP(n) (((n) + RECORD_ALIGN - 1) & ~(size_t)(RECORD_ALIGN - 1))
+
+static uint64_t monotonic_ns(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000000ull + now.tv_nsec;
+}
+
+// Open a capture file for writing, truncating any previous contents
+bool imu_capture_open(ImuCaptureWriter *writer, const char *path) {
+    memset(writer, 0, sizeof(*writer));
+
+    writer->fd = open(path, O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (writer->fd < 0) {
+        fprintf(stderr, "Failed to open capture file %s: %s\n", path, strerror(errno));
+        return false;
+    }
+
+    // Reserve the blocks up front: stores into a sparse mapping that the disk
+    // has no room for would fault with SIGBUS instead of failing
+    writer->map_size = CAPTURE_GROW_SIZE;
+    int result = posix_fallocate(writer->fd, 0, writer->map_size);
+    if (result != 0) {
+        fprintf(stderr, "Failed to size capture file: %s\n", strerror(result));
+        close(writer->fd);
+        return false;
+    }
+
+    writer->map = mmap(NULL, writer->map_size, PROT_READ | PROT_WRITE, MAP_SHARED, writer->fd, 0);
+    if (writer->map == MAP_FAILED) {
+        fprintf(stderr, "Failed to map capture file: %s\n", strerror(errno));
+        close(writer->fd);
+        return false;
+    }
+
+    ImuCaptureHeader *header = (ImuCaptureHeader *)writer->map;
+    memcpy(header->magic, IMU_CAPTURE_MAGIC, 4);
+    header->version = IMU_CAPTURE_VERSION;
+    header->header_size = sizeof(ImuCaptureHeader);
+    header->data_size = 0;
+    header->record_count = 0;
+
+    writer->start_ns = monotonic_ns();
+    return true;
+}
+
+// Trim the file to its used size and release it
+static void finish_capture(ImuCaptureWriter *writer) {
+    const ImuCaptureHeader *header = (const ImuCaptureHeader *)writer->map;
+    size_t used = sizeof(ImuCaptureHeader) + header->data_size;
+
+    munmap(writer->map, writer->map_size);
+    if (ftruncate(writer->fd, used) < 0) {
+        fprintf(stderr, "Warning: Could not trim capture file\n");
+    }
+    close(writer->fd);
+    writer->map = NULL;
+    writer->fd = -1;
+}
+
+// Append one record. Called from the SDK thread, so the common case is two
+// memcpys; the file is only grown and remapped once per CAPTURE_GROW_SIZE
+// bytes. If it can't grow (usually a full disk) the capture ends there, with
+// everything recorded so far kept.
+bool imu_capture_append(ImuCaptureWriter *writer, const uint8_t *data, uint16_t len, uint32_t ts) {
+    if (!writer->map) return false;
+
+    ImuCaptureHeader *header = (ImuCaptureHeader *)writer->map;
+    size_t offset = sizeof(ImuCaptureHeader) + header->data_size;
+    size_t record_size = ALIGN_UP(sizeof(ImuCaptureRecord) + len);
+
+    if (offset + record_size > writer->map_size) {
+        size_t new_size = writer->map_size + CAPTURE_GROW_SIZE;
+        int result = posix_fallocate(writer->fd, writer->map_size, CAPTURE_GROW_SIZE);
+        uint8_t *map = MAP_FAILED;
+        if (result == 0) {
+            map = mremap(writer->map, writer->map_size, new_size, MREMAP_MAYMOVE);
+            if (map == MAP_FAILED) result = errno;
+        }
+        if (result != 0) {
+            fprintf(stderr, "Warning: Capture stopped after %llu IMU samples, cannot grow file: %s\n",
+                    (unsigned long long)header->record_count, strerror(result));
+            finish_capture(writer);
+            return false;
+        }
+        writer->map = map;
+        writer->map_size = new_size;
+        header = (ImuCaptureHeader *)writer->map;
+    }
+
+    ImuCaptureRecord record = {
+        .time_ns = monotonic_ns() - writer->start_ns,
+        .ts = ts,
+        .len = len,
+        .reserved = 0
+    };
+    memcpy(writer->map + offset, &record, sizeof(record));
+    memcpy(writer->map + offset + sizeof(record), data, len);
+
+    // Publish the record only once it's complete
+    header->data_size += record_size;
+    header->record_count++;
+    return true;
+}
+
+void imu_capture_close(ImuCaptureWriter *writer) {
+    if (!writer->map) return;
+
+    const ImuCaptureHeader *header = (const ImuCaptureHeader *)writer->map;
+    printf("Captured %llu IMU samples\n", (unsigned long long)header->record_count);
+    finish_capture(writer);
+}
+
+// Open a capture file for reading
+bool imu_capture_open_read(ImuCaptureReader *reader, const char *path) {
+    memset(reader, 0, sizeof(*reader));
+
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        fprintf(stderr, "Failed to open capture file %s: %s\n", path, strerror(errno));
+        return false;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) < 0 || (size_t)st.st_size < sizeof(ImuCaptureHeader)) {
+        fprintf(stderr, "Capture file %s is too short\n", path);
+        close(fd);
+        return false;
+    }
+
+    // Private writable mapping: callbacks take non-const data, writes stay local
+    reader->map_size = st.st_size;
+    reader->map = mmap(NULL, reader->map_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (reader->map == MAP_FAILED) {
+        fprintf(stderr, "Failed to map capture file: %s\n", strerror(errno));
+        reader->map = NULL;
+        return false;
+    }
+
+    reader->header = (const ImuCaptureHeader *)reader->map;
+    if (memcmp(reader->header->magic, IMU_CAPTURE_MAGIC, 4) != 0 ||
+        reader->header->version != IMU_CAPTURE_VERSION ||
+        reader->header->header_size < sizeof(ImuCaptureHeader) ||
+        reader->header->header_size + reader->header->data_size > reader->map_size) {
+        fprintf(stderr, "%s is not a valid IMU capture\n", path);
+        imu_capture_close_read(reader);
+        return false;
+    }
+
+    reader->offset = reader->header->header_size;
+    return true;
+}
+
+const ImuCaptureRecord* imu_capture_next(ImuCaptureReader *reader, uint8_t **payload) {
+    size_t end = reader->header->header_size + reader->header->data_size;
+    if (reader->offset + sizeof(ImuCaptureRecord) > end) return NULL;
+
+    const ImuCaptureRecord *record = (const ImuCaptureRecord *)(reader->map + reader->offset);
+    size_t record_size = ALIGN_UP(sizeof(ImuCaptureRecord) + record->len);
+    if (reader->offset + record_size > end) return NULL;
+
+    *payload = reader->map + reader->offset + sizeof(ImuCaptureRecord);
+    reader->offset += record_size;
+    return record;
+}
+
+void imu_capture_close_read(ImuCaptureReader *reader) {
+    if (reader->map) {
+        munmap(reader->map, reader->map_size);
+    }
+    reader->map = NULL;
+    reader->header = NULL;
+}
+
+// Replay a capture through callback
+long imu_replay(const char *path, double speed, ImuReplayCallback callback) {
+    ImuCaptureReader reader;
+    if (!imu_capture_open_read(&reader, path)) {
+        return -1;
+    }
+
+    const ImuCaptureRecord *record;
+    uint8_t *payload;
+    long count = 0;
+    uint64_t start_ns = monotonic_ns();
+    uint64_t first_ns = 0;
+
+    while ((record = imu_capture_next(&reader, &payload)) != NULL) {
+        if (count == 0) {
+            first_ns = record->time_ns;
+        }
+        if (speed > 0.0) {
+            // Sleep until the record's original arrival time, scaled by speed
+            uint64_t due_ns = start_ns + (uint64_t)((record->time_ns - first_ns) / speed);
+            struct timespec due = {
+                .tv_sec = due_ns / 1000000000ull,
+                .tv_nsec = due_ns % 1000000000ull
+            };
+            while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &due, NULL) == EINTR) {
+            }
+        }
+        callback(payload, record->len, record->ts, record->time_ns);
+        count++;
+    }
+
+    imu_capture_close_read(&reader);
+    return count;
+}
@@ -0,0 +1,73 @@
+#ifndef IMU_CAPTURE_H
+#define IMU_CAPTURE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Raw IMU capture file: a small header followed by append-only records, each
+// holding one (data, len, ts) triple exactly as the SDK delivered it.
+//
+//   ImuCaptureHeader
+//   ImuCaptureRecord + payload (padded to 8 bytes)
+//   ImuCaptureRecord + payload
+//   ...
+//
+// All fields are host-endian; payload bytes are copied verbatim.
+
+#define IMU_CAPTURE_MAGIC   "VIMU"
+#define IMU_CAPTURE_VERSION 1
+
+typedef struct {
+    char magic[4];              // IMU_CAPTURE_MAGIC
+    uint16_t version;           // IMU_CAPTURE_VERSION
+    uint16_t header_size;       // sizeof(ImuCaptureHeader), lets readers skip future fields
+    uint64_t data_size;         // Bytes of complete records after the header
+    uint64_t record_count;      // Number of complete records
+} ImuCaptureHeader;
+
+typedef struct {
+    uint64_t time_ns;           // CLOCK_MONOTONIC arrival time relative to capture start
+    uint32_t ts;                // SDK timestamp
+    uint16_t len;               // Payload length in bytes
+    uint16_t reserved;
+} ImuCaptureRecord;
+
+// Writer: file is memory-mapped and grown in chunks with their blocks
+// reserved, so a full disk ends the capture cleanly; the header is updated
+// after each record so a crash leaves a readable file
+typedef struct {
+    int fd;
+    uint8_t *map;
+    size_t map_size;
+    uint64_t start_ns;
+} ImuCaptureWriter;
+
+// Reader: whole file mapped privately so payloads can be handed to callbacks
+typedef struct {
+    uint8_t *map;
+    size_t map_size;
+    size_t offset;
+    const ImuCaptureHeader *header;
+} ImuCaptureReader;
+
+// Called for each replayed record with the SDK IMU callback's arguments and
+// the record's time_ns, so the pipeline can be timed by when samples arrived
+// rather than by the replay's pace
+typedef void (*ImuReplayCallback)(uint8_t *data, uint16_t len, uint32_t ts, uint64_t time_ns);
+
+bool imu_capture_open(ImuCaptureWriter *writer, const char *path);
+bool imu_capture_append(ImuCaptureWriter *writer, const uint8_t *data, uint16_t len, uint32_t ts);
+void imu_capture_close(ImuCaptureWriter *writer);
+
+bool imu_capture_open_read(ImuCaptureReader *reader, const char *path);
+// Returns the next record and points *payload at its bytes, or NULL at the end
+const ImuCaptureRecord* imu_capture_next(ImuCaptureReader *reader, uint8_t **payload);
+void imu_capture_close_read(ImuCaptureReader *reader);
+
+// Feed every record of a capture to callback. speed 1.0 keeps the original
+// pace, N plays N times faster and 0 plays as fast as possible.
+// Returns the number of records replayed, or -1 if the file can't be read.
+long imu_replay(const char *path, double speed, ImuReplayCallback callback);
+
+#endif // IMU_CAPTURE_H
@@ -0,0 +1,252 @@
+#include <stdio.h>
+#include <math.h>
+#include <errno.h>
+#include <unistd.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+
+#include "viture.h"
+#include "imu_power.h"
+#include "latency_histogram.h"
+
+// Head speed is measured over at least this long, so sensor noise between
+// neighbouring samples doesn't count as motion
+#define MOTION_WINDOW_NS 50000000ull
+
+// Wakeups per second are counted over windows this long. A callback closes
+// the window, so once the stream slows or stops the open window is reported
+#define WAKEUP_WINDOW_NS 1000000000ull
+
+// Map an IMU rate in Hz to the SDK's frequency setting
+static int imu_frequency(int rate) {
+    switch (rate) {
+        case 60:  return IMU_FREQUENCE_60;
+        case 90:  return IMU_FREQUENCE_90;
+        case 240: return IMU_FREQUENCE_240;
+        default:  return IMU_FREQUENCE_120;
+    }
+}
+
+const char* imu_power_mode_name(ImuPowerMode mode) {
+    switch (mode) {
+        case IMU_POWER_LOW: return "low";
+        case IMU_POWER_OFF: return "off";
+        default:            return "full";
+    }
+}
+
+static void wake(ImuPower *power) {
+    if (!atomic_load(&power->running)) return;
+
+    uint64_t one = 1;
+    if (write(power->wake_fd, &one, sizeof(one)) < 0) {
+        perror("Failed to wake IMU power thread");
+    }
+}
+
+// State the stream should be in for the current requests
+static ImuPowerMode wanted_mode(ImuPower *power) {
+    if (!atomic_load(&power->active)) {
+        switch (atomic_load(&power->disabled_imu)) {
+            case IMU_DISABLED_LOW:  return IMU_POWER_LOW;
+            case IMU_DISABLED_FULL: return IMU_POWER_FULL;
+            default:                return IMU_POWER_OFF;
+        }
+    }
+    if (atomic_load(&power->still) && atomic_load(&power->still_timeout_ms) > 0) {
+        return IMU_POWER_LOW;
+    }
+    return IMU_POWER_FULL;
+}
+
+// Bring the glasses to the wanted state; true if the rate changed
+static bool apply(ImuPower *power) {
+    ImuPowerMode target = wanted_mode(power);
+    ImuPowerMode mode = atomic_load(&power->mode);
+
+    if (target == IMU_POWER_OFF) {
+        if (mode == IMU_POWER_OFF) return false;
+        int result = set_imu(false);
+        if (result != ERR_SUCCESS) {
+            fprintf(stderr, "Warning: Failed to stop IMU data (error %d)\n", result);
+            return false;
+        }
+        atomic_store(&power->mode, IMU_POWER_OFF);
+        printf("IMU stream stopped\n");
+        return false;
+    }
+
+    int rate = target == IMU_POWER_LOW ? IMU_POWER_LOW_RATE : atomic_load(&power->full_rate);
+    bool changed = false;
+    if (rate != atomic_load(&power->rate)) {
+        int result = set_imu_fq(imu_frequency(rate));
+        if (result != ERR_SUCCESS) {
+            fprintf(stderr, "Warning: Failed to set IMU rate to %d Hz (error %d)\n", rate, result);
+        } else {
+            atomic_store(&power->rate, rate);
+            changed = true;
+        }
+    }
+
+    if (mode == IMU_POWER_OFF) {
+        int result = set_imu(true);
+        if (result != ERR_SUCCESS) {
+            fprintf(stderr, "Warning: Failed to restart IMU data (error %d)\n", result);
+            return changed;
+        }
+    }
+    if (target != mode) {
+        printf("IMU stream at %d Hz (%s)\n", atomic_load(&power->rate), imu_power_mode_name(target));
+    }
+    atomic_store(&power->mode, target);
+    return changed;
+}
+
+static void* imu_power_thread(void *arg) {
+    ImuPower *power = (ImuPower *)arg;
+    struct pollfd pfd = { .fd = power->wake_fd, .events = POLLIN };
+
+    while (poll(&pfd, 1, -1) >= 0 || errno == EINTR) {
+        uint64_t count;
+        if (read(power->wake_fd, &count, sizeof(count)) < 0 && errno != EAGAIN) break;
+        if (!atomic_load(&power->running)) break;
+
+        if (apply(power) && power->on_rate_change) {
+            power->on_rate_change();
+        }
+    }
+    return NULL;
+}
+
+static void store_settings(ImuPower *power, const MouseConfig *config) {
+    atomic_store(&power->full_rate, config->imu_rate);
+    atomic_store(&power->disabled_imu, config->disabled_imu);
+    atomic_store(&power->still_timeout_ms, config->still_timeout_ms);
+    atomic_store(&power->still_threshold, config->still_threshold);
+}
+
+bool imu_power_start(ImuPower *power, const MouseConfig *config, bool active) {
+    store_settings(power, config);
+    atomic_store(&power->active, active);
+    atomic_store(&power->still, false);
+    atomic_store(&power->last_motion_ns, latency_now_ns());
+    atomic_store(&power->mode, IMU_POWER_FULL);
+    atomic_store(&power->rate, 0);
+    apply(power);
+
+    power->wake_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (power->wake_fd < 0) {
+        perror("Failed to create IMU power eventfd");
+        return false;
+    }
+    atomic_store(&power->running, true);
+    if (pthread_create(&power->thread, NULL, imu_power_thread, power) != 0) {
+        perror("Failed to create IMU power thread");
+        atomic_store(&power->running, false);
+        close(power->wake_fd);
+        return false;
+    }
+    return true;
+}
+
+void imu_power_stop(ImuPower *power) {
+    if (!atomic_load(&power->running)) return;
+
+    uint64_t one = 1;
+    atomic_store(&power->running, false);
+    if (write(power->wake_fd, &one, sizeof(one)) < 0) {
+        perror("Failed to wake IMU power thread");
+    }
+    pthread_join(power->thread, NULL);
+    close(power->wake_fd);
+}
+
+void imu_power_configure(ImuPower *power, const MouseConfig *config) {
+    store_settings(power, config);
+    wake(power);
+}
+
+void imu_power_set_active(ImuPower *power, bool active) {
+    // Start out at full rate, as if the head just moved
+    atomic_store(&power->last_motion_ns, latency_now_ns());
+    atomic_store(&power->still, false);
+    atomic_store(&power->active, active);
+    wake(power);
+}
+
+// Smallest difference between two angles in degrees, across the ±180 wrap
+static float angle_delta(float a, float b) {
+    float delta = fabsf(a - b);
+    return delta > 180.0f ? 360.0f - delta : delta;
+}
+
+static void count_wakeup(ImuPower *power, uint64_t now) {
+    unsigned long long wakeups = atomic_fetch_add_explicit(&power->wakeups, 1, memory_order_relaxed) + 1;
+    uint64_t start = atomic_load_explicit(&power->window_start_ns, memory_order_relaxed);
+    if (now - start < WAKEUP_WINDOW_NS) return;
+
+    unsigned long long counted = wakeups - atomic_load_explicit(&power->window_start_wakeups, memory_order_relaxed);
+    if (start > 0) {
+        atomic_store(&power->wakeup_rate, counted * 1e9f / (now - start));
+    }
+    atomic_store(&power->window_start_wakeups, wakeups);
+    atomic_store(&power->window_start_ns, now);
+}
+
+void imu_power_sample(ImuPower *power, const MotionSample *sample) {
+    uint64_t now = sample->arrival_ns;
+    count_wakeup(power, now);
+
+    int timeout_ms = atomic_load_explicit(&power->still_timeout_ms, memory_order_relaxed);
+    if (!atomic_load_explicit(&power->active, memory_order_relaxed) || timeout_ms <= 0) {
+        power->have_reference = false;
+        return;
+    }
+    if (!power->have_reference) {
+        power->reference = *sample;
+        power->have_reference = true;
+        return;
+    }
+
+    uint64_t elapsed = now - power->reference.arrival_ns;
+    if (elapsed < MOTION_WINDOW_NS) return;
+
+    float moved = fmaxf(angle_delta(sample->yaw, power->reference.yaw),
+                        fmaxf(angle_delta(sample->pitch, power->reference.pitch),
+                              angle_delta(sample->roll, power->reference.roll)));
+    float threshold = atomic_load_explicit(&power->still_threshold, memory_order_relaxed);
+    power->reference = *sample;
+
+    bool still = atomic_load(&power->still);
+    if (moved > threshold * (elapsed / 1e9f)) {
+        atomic_store(&power->last_motion_ns, now);
+        if (still) {
+            atomic_store(&power->still, false);
+            wake(power);
+        }
+    } else if (!still && now - atomic_load(&power->last_motion_ns) >= (uint64_t)timeout_ms * 1000000ull) {
+        atomic_store(&power->still, true);
+        wake(power);
+    }
+}
+
+int imu_power_rate(ImuPower *power) {
+    int rate = atomic_load(&power->rate);
+    return rate > 0 ? rate : atomic_load(&power->full_rate);
+}
+
+void imu_power_format_stats(ImuPower *power, char *buffer, size_t size) {
+    // With no callback for a while the last window is stale; count the
+    // wakeups since it started instead
+    float rate = atomic_load(&power->wakeup_rate);
+    uint64_t now = latency_now_ns();
+    uint64_t start = atomic_load(&power->window_start_ns);
+    unsigned long long wakeups = atomic_load(&power->wakeups);
+    if (start > 0 && now - start >= 2 * WAKEUP_WINDOW_NS) {
+        rate = (wakeups - atomic_load(&power->window_start_wakeups)) * 1e9f / (now - start);
+    }
+
+    snprintf(buffer, size, "imu_power=%s imu_rate=%d wakeups=%llu wakeups_per_sec=%.1f",
+             imu_power_mode_name(atomic_load(&power->mode)), atomic_load(&power->rate),
+             wakeups, rate);
+}
@@ -0,0 +1,79 @@
+#ifndef IMU_POWER_H
+#define IMU_POWER_H
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <pthread.h>
+
+#include "mouse_config.h"
+#include "motion_pipeline.h"
+
+// Lowest rate the glasses stream at (Hz)
+#define IMU_POWER_LOW_RATE 60
+
+// Stream states, lowest power last
+typedef enum {
+    IMU_POWER_FULL,             // Configured rate
+    IMU_POWER_LOW,              // IMU_POWER_LOW_RATE
+    IMU_POWER_OFF               // IMU stream stopped
+} ImuPowerMode;
+
+// Keeps the glasses from streaming faster than anyone needs. While tracking
+// is disabled or paused the stream is stopped or slowed (disabled_imu), and
+// once the head has been still for still_timeout_ms it drops to the lowest
+// rate until a sample moves faster than still_threshold.
+//
+// Samples are checked on the SDK thread, which only flags a change and wakes
+// the power thread; the SDK is reconfigured from there, never from inside its
+// own callback. on_rate_change is called on the power thread after the rate
+// changed, so the pipeline can be retuned to it.
+typedef struct {
+    // Set before imu_power_start
+    void (*on_rate_change)(void);
+
+    int wake_fd;                // eventfd that wakes the power thread
+    pthread_t thread;
+    atomic_bool running;
+
+    // Requested state (control and SDK threads)
+    atomic_bool active;         // Tracking enabled and not paused
+    atomic_bool still;          // Head still for still_timeout_ms
+    atomic_int full_rate;
+    atomic_int disabled_imu;    // ImuDisabledMode
+    atomic_int still_timeout_ms;
+    _Atomic float still_threshold;
+    atomic_ullong last_motion_ns;
+
+    // Applied state (power thread)
+    atomic_int mode;            // ImuPowerMode
+    atomic_int rate;            // Rate last set on the glasses (Hz)
+
+    // Motion check (SDK thread)
+    MotionSample reference;
+    bool have_reference;
+
+    // Callback wakeups, rate measured over about a second (SDK thread)
+    atomic_ullong wakeups;
+    atomic_ullong window_start_ns;
+    atomic_ullong window_start_wakeups;
+    _Atomic float wakeup_rate;
+} ImuPower;
+
+// Start managing an IMU stream that is already on. Sets the rate for the
+// current state before returning.
+bool imu_power_start(ImuPower *power, const MouseConfig *config, bool active);
+void imu_power_stop(ImuPower *power);
+// Pick up new imu_rate, disabled_imu and stillness settings
+void imu_power_configure(ImuPower *power, const MouseConfig *config);
+// Tracking was enabled, disabled, paused or resumed
+void imu_power_set_active(ImuPower *power, bool active);
+// SDK thread: count the wakeup and check the sample for motion
+void imu_power_sample(ImuPower *power, const MotionSample *sample);
+// Rate the glasses stream at, or were last streaming at when off (Hz)
+int imu_power_rate(ImuPower *power);
+const char* imu_power_mode_name(ImuPowerMode mode);
+void imu_power_format_stats(ImuPower *power, char *buffer, size_t size);
+
+#endif // IMU_POWER_H
@@ -0,0 +1,123 @@
+#include <string.h>
+#include <math.h>
+
+#include "imu_synth.h"
+#include "motion_pipeline.h"
+
+#define DEG_TO_RAD 0.017453292519943295
+
+static const char *signal_names[IMU_SYNTH_COUNT] = {
+    "stationary",
+    "slow_pan",
+    "fast_flick",
+    "roll_scroll",
+    "sine_sweep",
+    "step",
+};
+
+const char* imu_synth_name(ImuSynthSignal signal) {
+    return signal < IMU_SYNTH_COUNT ? signal_names[signal] : "unknown";
+}
+
+bool imu_synth_parse(const char *name, ImuSynthSignal *signal) {
+    for (int i = 0; i < IMU_SYNTH_COUNT; i++) {
+        if (strcmp(name, signal_names[i]) == 0) {
+            *signal = (ImuSynthSignal)i;
+            return true;
+        }
+    }
+    return false;
+}
+
+float imu_synth_noise(uint64_t index, unsigned int channel) {
+    uint64_t x = index * 0x9E3779B97F4A7C15ull + channel * 0xBF58476D1CE4E5B9ull;
+    x ^= x >> 31;
+    x *= 0x94D049BB133111EBull;
+    x ^= x >> 29;
+    return (float)((x >> 40) * (2.0 / 16777216.0) - 1.0);
+}
+
+// Sensor noise of a still head, in degrees
+#define NOISE_DEGREES 0.02f
+
+void imu_synth_pose(ImuSynthSignal signal, uint64_t index, int rate,
+                    float *roll, float *pitch, float *yaw) {
+    double t = (double)index / rate;
+    *roll = NOISE_DEGREES * imu_synth_noise(index, 0);
+    *pitch = NOISE_DEGREES * imu_synth_noise(index, 1);
+    *yaw = NOISE_DEGREES * imu_synth_noise(index, 2);
+
+    switch (signal) {
+        case IMU_SYNTH_SLOW_PAN:
+            *yaw += (float)(25.0 * sin(t * 0.8));
+            *pitch += (float)(8.0 * sin(t * 0.5));
+            break;
+
+        case IMU_SYNTH_FAST_FLICK: {
+            // 30 degree flicks every half second, each taking 80 ms
+            double phase = fmod(t, 0.5);
+            double progress = phase < 0.08 ? 0.5 - 0.5 * cos(phase / 0.08 * M_PI) : 1.0;
+            long flick = (long)(t / 0.5);
+            double from = (flick % 2) ? 15.0 : -15.0;
+            *yaw += (float)(from - 2.0 * from * progress);
+            break;
+        }
+
+        case IMU_SYNTH_ROLL_SCROLL:
+            // Two seconds tilted 20 degrees one way, then the other
+            *roll += (float)(20.0 * sin(t * M_PI * 0.25));
+            break;
+
+        case IMU_SYNTH_SINE_SWEEP: {
+            // Linear chirp; the phase is the integral of the frequency
+            double period = 20.0;
+            double f0 = 0.1, f1 = 5.0;
+            double s = fmod(t, period);
+            double phase = 2.0 * M_PI * (f0 * s + (f1 - f0) * s * s / (2.0 * period));
+            *yaw += (float)(10.0 * sin(phase));
+            break;
+        }
+
+        case IMU_SYNTH_STEP:
+            *yaw += (float)(10.0 * ((long)t % 4) - 15.0);
+            break;
+
+        default:
+            break;
+    }
+}
+
+static void put_float(uint8_t *data, float value) {
+    uint32_t bits;
+    memcpy(&bits, &value, 4);
+    bits = __builtin_bswap32(bits);
+    memcpy(data, &bits, 4);
+}
+
+void imu_synth_encode(float roll, float pitch, float yaw, uint8_t *packet) {
+    memset(packet, 0, IMU_SYNTH_PACKET_SIZE);
+    put_float(packet + IMU_OFFSET_ROLL, roll);
+    put_float(packet + IMU_OFFSET_PITCH, pitch);
+    put_float(packet + IMU_OFFSET_YAW, yaw);
+
+    // Quaternion for yaw about Z, then pitch about Y, then roll about X
+    double cy = cos(yaw * DEG_TO_RAD / 2), sy = sin(yaw * DEG_TO_RAD / 2);
+    double cp = cos(pitch * DEG_TO_RAD / 2), sp = sin(pitch * DEG_TO_RAD / 2);
+    double cr = cos(roll * DEG_TO_RAD / 2), sr = sin(roll * DEG_TO_RAD / 2);
+    put_float(packet + IMU_OFFSET_QUAT, (float)(cr * cp * cy + sr * sp * sy));
+    put_float(packet + IMU_OFFSET_QUAT + 4, (float)(sr * cp * cy - cr * sp * sy));
+    put_float(packet + IMU_OFFSET_QUAT + 8, (float)(cr * sp * cy + sr * cp * sy));
+    put_float(packet + IMU_OFFSET_QUAT + 12, (float)(cr * cp * sy - sr * sp * cy));
+}
+
+void imu_synth_generate(ImuSynthSignal signal, int rate, uint8_t *packets, size_t stride,
+                        uint32_t *ts, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        float roll, pitch, yaw;
+        imu_synth_pose(signal, i, rate, &roll, &pitch, &yaw);
+        imu_synth_encode(roll, pitch, yaw, packets + i * stride);
+        if (ts) {
+            ts[i] = (uint32_t)(i * 1000 / rate);
+        }
+    }
+}
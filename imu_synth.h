@@ -0,0 +1,44 @@
+#ifndef IMU_SYNTH_H
+#define IMU_SYNTH_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Synthetic head motion encoded as Viture SDK IMU packets, for benchmarks and
+// hardware-free runs. Every signal is a pure function of the sample index, so
+// the same index always gives the same packet.
+
+// Bytes per packet: Euler angles, padding and quaternion, as the glasses send
+#define IMU_SYNTH_PACKET_SIZE 36
+
+typedef enum {
+    IMU_SYNTH_STATIONARY,       // Head still, sensor noise only
+    IMU_SYNTH_SLOW_PAN,         // Slow side to side and up and down reading motion
+    IMU_SYNTH_FAST_FLICK,       // Quick 30 degree flicks between targets
+    IMU_SYNTH_ROLL_SCROLL,      // Head tilted past the scroll threshold and back
+    IMU_SYNTH_SINE_SWEEP,       // Yaw sine sweeping from 0.1 to 5 Hz every 20 seconds
+    IMU_SYNTH_STEP,             // Yaw stepping 10 degrees a second up a 4-step staircase
+    IMU_SYNTH_COUNT
+} ImuSynthSignal;
+
+const char* imu_synth_name(ImuSynthSignal signal);
+
+// Look a signal up by name; returns false if there's no such signal
+bool imu_synth_parse(const char *name, ImuSynthSignal *signal);
+
+// Deterministic noise in [-1, 1] for a sample index and channel
+float imu_synth_noise(uint64_t index, unsigned int channel);
+
+// Orientation in degrees of sample index at rate Hz
+void imu_synth_pose(ImuSynthSignal signal, uint64_t index, int rate,
+                    float *roll, float *pitch, float *yaw);
+
+// Encode an orientation as an SDK packet (big-endian floats with quaternion)
+void imu_synth_encode(float roll, float pitch, float yaw, uint8_t *packet);
+
+// Fill count packets, stride bytes apart, and their SDK millisecond timestamps
+void imu_synth_generate(ImuSynthSignal signal, int rate, uint8_t *packets, size_t stride,
+                        uint32_t *ts, size_t count);
+
+#endif // IMU_SYNTH_H
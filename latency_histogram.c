@@ -0,0 +1,82 @@
+#include <stdio.h>
+#include <time.h>
+
+#include "latency_histogram.h"
+
+// Bucket index for a value: values below LATENCY_SUB_BUCKETS are exact, larger
+// ones keep their top LATENCY_SUB_BITS + 1 significant bits
+static size_t bucket_index(uint64_t ns) {
+    if (ns < LATENCY_SUB_BUCKETS) return ns;
+
+    int magnitude = 63 - __builtin_clzll(ns);
+    if (magnitude > LATENCY_MAX_MAGNITUDE) {
+        return LATENCY_BUCKETS - 1;
+    }
+    int shift = magnitude - LATENCY_SUB_BITS;
+    size_t sub = (ns >> shift) - LATENCY_SUB_BUCKETS;
+    return (size_t)(shift + 1) * LATENCY_SUB_BUCKETS + sub;
+}
+
+// Largest value that lands in a bucket
+static uint64_t bucket_upper_bound(size_t index) {
+    if (index < LATENCY_SUB_BUCKETS) return index;
+
+    int shift = (int)(index / LATENCY_SUB_BUCKETS) - 1;
+    uint64_t sub = index % LATENCY_SUB_BUCKETS;
+    return ((LATENCY_SUB_BUCKETS + sub + 1) << shift) - 1;
+}
+
+void latency_histogram_record(LatencyHistogram *histogram, uint64_t ns) {
+    atomic_fetch_add_explicit(&histogram->buckets[bucket_index(ns)], 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&histogram->count, 1, memory_order_relaxed);
+
+    unsigned long long max = atomic_load_explicit(&histogram->max, memory_order_relaxed);
+    while (ns > max &&
+           !atomic_compare_exchange_weak_explicit(&histogram->max, &max, ns,
+                                                  memory_order_relaxed, memory_order_relaxed)) {
+    }
+}
+
+uint64_t latency_histogram_percentile(LatencyHistogram *histogram, double fraction) {
+    uint64_t count = atomic_load_explicit(&histogram->count, memory_order_relaxed);
+    uint64_t max = atomic_load_explicit(&histogram->max, memory_order_relaxed);
+    if (count == 0) return 0;
+
+    uint64_t target = (uint64_t)(fraction * count + 0.5);
+    if (target < 1) target = 1;
+
+    uint64_t seen = 0;
+    for (size_t i = 0; i < LATENCY_BUCKETS; i++) {
+        seen += atomic_load_explicit(&histogram->buckets[i], memory_order_relaxed);
+        if (seen >= target) {
+            uint64_t value = bucket_upper_bound(i);
+            return value < max ? value : max;
+        }
+    }
+    return max;
+}
+
+void latency_histogram_reset(LatencyHistogram *histogram) {
+    for (size_t i = 0; i < LATENCY_BUCKETS; i++) {
+        atomic_store_explicit(&histogram->buckets[i], 0, memory_order_relaxed);
+    }
+    atomic_store(&histogram->count, 0);
+    atomic_store(&histogram->max, 0);
+}
+
+void latency_histogram_format(LatencyHistogram *histogram, const char *name,
+                              char *buffer, size_t size) {
+    snprintf(buffer, size,
+             "%s_n=%llu %s_p50=%.1fus %s_p90=%.1fus %s_p99=%.1fus %s_max=%.1fus",
+             name, (unsigned long long)atomic_load(&histogram->count),
+             name, latency_histogram_percentile(histogram, 0.50) / 1000.0,
+             name, latency_histogram_percentile(histogram, 0.90) / 1000.0,
+             name, latency_histogram_percentile(histogram, 0.99) / 1000.0,
+             name, atomic_load(&histogram->max) / 1000.0);
+}
+
+uint64_t latency_now_ns(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000000ull + now.tv_nsec;
+}
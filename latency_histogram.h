@@ -0,0 +1,39 @@
+#ifndef LATENCY_HISTOGRAM_H
+#define LATENCY_HISTOGRAM_H
+
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Log-linear (HDR-style) histogram of nanosecond durations. Each power of two
+// is split into LATENCY_SUB_BUCKETS buckets, so every recorded value is kept
+// to within ~3% from nanoseconds up to minutes. Recording is lock-free and
+// wait-free, so it is safe on the SDK and emitter threads.
+#define LATENCY_SUB_BITS        5
+#define LATENCY_SUB_BUCKETS     (1 << LATENCY_SUB_BITS)
+#define LATENCY_MAX_MAGNITUDE   40      // Values are clamped to 2^40 ns (~18 minutes)
+#define LATENCY_BUCKETS         ((LATENCY_MAX_MAGNITUDE - LATENCY_SUB_BITS + 2) * LATENCY_SUB_BUCKETS)
+
+typedef struct {
+    atomic_ullong buckets[LATENCY_BUCKETS];
+    atomic_ullong count;
+    atomic_ullong max;
+} LatencyHistogram;
+
+// Record one duration
+void latency_histogram_record(LatencyHistogram *histogram, uint64_t ns);
+
+// Value at or below which the given fraction (0.0-1.0) of samples fall
+uint64_t latency_histogram_percentile(LatencyHistogram *histogram, double fraction);
+
+// Clear all samples. Samples recorded concurrently may or may not survive.
+void latency_histogram_reset(LatencyHistogram *histogram);
+
+// Format "name_n=... name_p50=...us name_p90=...us name_p99=...us name_max=...us"
+void latency_histogram_format(LatencyHistogram *histogram, const char *name,
+                              char *buffer, size_t size);
+
+// CLOCK_MONOTONIC in nanoseconds
+uint64_t latency_now_ns(void);
+
+#endif // LATENCY_HISTOGRAM_H
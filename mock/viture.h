@@ -0,0 +1,36 @@
+#ifndef VITURE_H
+#define VITURE_H
+
+// The part of the Viture One SDK's viture.h this project uses, for building
+// against the mock SDK (mock_sdk.c) on machines without the real SDK. Builds
+// against libs/ use the SDK's own header from include/ instead.
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Return codes
+#define ERR_SUCCESS 0
+#define ERR_FAILURE 1
+
+// set_imu_fq values
+#define IMU_FREQUENCE_60  0x00
+#define IMU_FREQUENCE_90  0x01
+#define IMU_FREQUENCE_120 0x02
+#define IMU_FREQUENCE_240 0x03
+
+// IMU packets: roll, pitch and yaw as big-endian floats, then a quaternion
+typedef void (*Callback)(uint8_t *data, uint16_t len, uint32_t ts);
+// MCU events, msgid identifies the event
+typedef void (*MCUCallback)(uint16_t msgid, uint8_t *data, uint16_t len, uint32_t ts);
+
+// Connect to the glasses and register the callbacks, false if none are found
+bool init(Callback imuCallback, MCUCallback mcuCallback);
+void deinit();
+
+// Start or stop the IMU stream
+int set_imu(bool onoff);
+
+// Set the IMU stream rate (IMU_FREQUENCE_*)
+int set_imu_fq(int value);
+
+#endif // VITURE_H
@@ -0,0 +1,186 @@
+// Stand-in for libviture_one_sdk, so the daemons run without glasses (CI,
+// build hosts, load and latency tests). It implements the SDK's entry points
+// and streams scripted head motion from imu_synth.c to the registered IMU
+// callback from its own thread, at the rate set with set_imu_fq.
+//
+// The motion is chosen with environment variables:
+//   VITURE_MOCK_SIGNAL   stationary, slow_pan, fast_flick, roll_scroll,
+//                        sine_sweep (default) or step
+//   VITURE_MOCK_NOISE    extra sensor noise in degrees (default 0)
+//   VITURE_MOCK_LOSS     percentage of packets dropped (default 0)
+//   VITURE_MOCK_JITTER   most milliseconds a packet is delivered late, with its
+//                        ts stamped to match (default 0)
+//   VITURE_MOCK_MCU_HZ   rate of MCU heartbeat callbacks (default 1, 0 = none)
+// Noise, loss and jitter are pseudo-random but repeat from run to run.
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <pthread.h>
+#include <stdatomic.h>
+
+#include "viture.h"
+#include "imu_synth.h"
+
+// msgid of the heartbeat passed to the MCU callback
+#define MOCK_MCU_HEARTBEAT 0x0000
+
+// Noise channels, clear of the ones imu_synth_pose uses
+#define CHANNEL_NOISE 8
+#define CHANNEL_LOSS 11
+#define CHANNEL_JITTER 12
+
+static Callback imu_callback;
+static MCUCallback mcu_callback;
+
+static ImuSynthSignal mock_signal = IMU_SYNTH_SINE_SWEEP;
+static float noise_degrees;
+static float loss_fraction;
+static float jitter_ms;
+static int mcu_rate = 1;
+
+static pthread_t thread;
+static atomic_bool running;
+static atomic_bool streaming;
+static atomic_int rate = 60;
+
+static void read_environment(void) {
+    const char *value = getenv("VITURE_MOCK_SIGNAL");
+    if (value && !imu_synth_parse(value, &mock_signal)) {
+        fprintf(stderr, "Mock SDK: unknown signal '%s', using %s\n", value, imu_synth_name(mock_signal));
+    }
+    if ((value = getenv("VITURE_MOCK_NOISE"))) noise_degrees = strtof(value, NULL);
+    if ((value = getenv("VITURE_MOCK_LOSS"))) loss_fraction = strtof(value, NULL) / 100.0f;
+    if ((value = getenv("VITURE_MOCK_JITTER"))) jitter_ms = strtof(value, NULL);
+    if ((value = getenv("VITURE_MOCK_MCU_HZ"))) mcu_rate = atoi(value);
+}
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+static void sleep_until(uint64_t deadline_ns) {
+    struct timespec ts = {
+        .tv_sec = deadline_ns / 1000000000ull,
+        .tv_nsec = deadline_ns % 1000000000ull
+    };
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) != 0) {
+    }
+}
+
+// Send packet index, due at due_ns, unless it is lost
+static void send_packet(uint64_t index, uint64_t due_ns, uint64_t start_ns, int hz) {
+    if (loss_fraction > 0.0f && (imu_synth_noise(index, CHANNEL_LOSS) + 1.0f) * 0.5f < loss_fraction) {
+        return;
+    }
+
+    // Late delivery, never past the next packet so order is kept
+    if (jitter_ms > 0.0f) {
+        uint64_t late_ns = (uint64_t)((imu_synth_noise(index, CHANNEL_JITTER) + 1.0f) * 0.5f *
+                                      jitter_ms * 1e6f);
+        uint64_t period_ns = 1000000000ull / hz;
+        due_ns += late_ns < period_ns ? late_ns : period_ns - 1;
+        sleep_until(due_ns);
+    }
+
+    float roll, pitch, yaw;
+    imu_synth_pose(mock_signal, index, hz, &roll, &pitch, &yaw);
+    roll += noise_degrees * imu_synth_noise(index, CHANNEL_NOISE);
+    pitch += noise_degrees * imu_synth_noise(index, CHANNEL_NOISE + 1);
+    yaw += noise_degrees * imu_synth_noise(index, CHANNEL_NOISE + 2);
+
+    uint8_t packet[IMU_SYNTH_PACKET_SIZE];
+    imu_synth_encode(roll, pitch, yaw, packet);
+    imu_callback(packet, sizeof(packet), (uint32_t)((due_ns - start_ns) / 1000000ull));
+}
+
+// Device thread: IMU packets at the configured rate while streaming, MCU
+// heartbeats at mcu_rate
+static void* device_thread(void *arg) {
+    uint64_t start_ns = now_ns();
+    uint64_t next_imu_ns = start_ns;
+    uint64_t next_mcu_ns = start_ns;
+    uint64_t index = 0;
+    int hz = atomic_load(&rate);
+
+    while (atomic_load(&running)) {
+        if (atomic_load(&rate) != hz) {
+            // Keep the motion continuous across a rate change
+            int fresh = atomic_load(&rate);
+            index = index * fresh / hz;
+            hz = fresh;
+        }
+
+        uint64_t now = now_ns();
+        if (mcu_rate > 0 && now >= next_mcu_ns) {
+            if (mcu_callback) {
+                mcu_callback(MOCK_MCU_HEARTBEAT, NULL, 0, (uint32_t)((now - start_ns) / 1000000ull));
+            }
+            next_mcu_ns += 1000000000ull / mcu_rate;
+        }
+
+        if (!atomic_load(&streaming)) {
+            // Idle: poll for set_imu at a slow tick
+            sleep_until(now + 10000000ull);
+            next_imu_ns = now_ns();
+            continue;
+        }
+
+        if (now < next_imu_ns) {
+            sleep_until(next_imu_ns);
+        }
+        if (imu_callback) {
+            send_packet(index, next_imu_ns, start_ns, hz);
+        }
+        index++;
+        next_imu_ns += 1000000000ull / hz;
+    }
+    return NULL;
+}
+
+bool init(Callback imuCallback, MCUCallback mcuCallback) {
+    if (atomic_load(&running)) return false;
+
+    imu_callback = imuCallback;
+    mcu_callback = mcuCallback;
+    read_environment();
+
+    atomic_store(&streaming, false);
+    atomic_store(&running, true);
+    if (pthread_create(&thread, NULL, device_thread, NULL) != 0) {
+        perror("Mock SDK: failed to create device thread");
+        atomic_store(&running, false);
+        return false;
+    }
+
+    fprintf(stderr, "Mock SDK: no glasses, streaming %s (noise %.2f deg, loss %.1f%%, jitter %.1f ms)\n",
+            imu_synth_name(mock_signal), noise_degrees, loss_fraction * 100.0f, jitter_ms);
+    return true;
+}
+
+void deinit() {
+    if (!atomic_exchange(&running, false)) return;
+    pthread_join(thread, NULL);
+    imu_callback = NULL;
+    mcu_callback = NULL;
+}
+
+int set_imu(bool onoff) {
+    if (!atomic_load(&running)) return ERR_FAILURE;
+    atomic_store(&streaming, onoff);
+    return ERR_SUCCESS;
+}
+
+int set_imu_fq(int value) {
+    switch (value) {
+        case IMU_FREQUENCE_60:  atomic_store(&rate, 60); break;
+        case IMU_FREQUENCE_90:  atomic_store(&rate, 90); break;
+        case IMU_FREQUENCE_120: atomic_store(&rate, 120); break;
+        case IMU_FREQUENCE_240: atomic_store(&rate, 240); break;
+        default: return ERR_FAILURE;
+    }
+    return ERR_SUCCESS;
+}
@@ -0,0 +1,207 @@
+// Per-sample cost of decoding and transforming IMU packets, for each
+// synthetic signal in imu_synth.h. The transform is measured with the
+// routine specialized for the config, the unspecialized pipeline it replaced
+// (which checked every stage at run time and always ran the deadzone and
+// smoothing), and the batch API.
+//
+// Usage: motion_bench [SAMPLES]
+// Prints one key=value line per signal, config and routine:
+//   bench=motion signal=slow_pan config=default stages=0x00 routine=specialized ns_per_sample=7.61 speedup=1.33
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "motion_pipeline.h"
+#include "imu_synth.h"
+
+#define DEFAULT_SAMPLES 200000
+#define RUNS 5
+#define RATE 120
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+// One signal's packets, and the same samples decoded both ways
+typedef struct {
+    uint8_t *packets;
+    uint32_t *ts;
+    MotionSample *samples;
+    MotionBatch batch;
+    size_t count;
+} BenchData;
+
+// Keeps results observable so the work can't be optimized away
+static volatile long long sink;
+
+// Best-of-RUNS nanoseconds per sample to decode every packet
+static double measure_decode(const BenchData *data) {
+    double best = 0.0;
+    for (int run = 0; run < RUNS; run++) {
+        uint64_t start = now_ns();
+        for (size_t i = 0; i < data->count; i++) {
+            motion_decode(data->packets + i * IMU_SYNTH_PACKET_SIZE, IMU_SYNTH_PACKET_SIZE,
+                          data->ts[i], &data->samples[i]);
+        }
+        double ns = (double)(now_ns() - start) / data->count;
+
+        sink += (long long)data->samples[data->count - 1].yaw;
+        if (run == 0 || ns < best) best = ns;
+    }
+    return best;
+}
+
+// Best-of-RUNS nanoseconds per sample to decode into the batch columns
+static double measure_decode_batch(BenchData *data) {
+    double best = 0.0;
+    for (int run = 0; run < RUNS; run++) {
+        uint64_t start = now_ns();
+        motion_decode_batch(data->packets, IMU_SYNTH_PACKET_SIZE, data->count, &data->batch);
+        double ns = (double)(now_ns() - start) / data->count;
+
+        sink += (long long)data->batch.yaw[data->count - 1];
+        if (run == 0 || ns < best) best = ns;
+    }
+    return best;
+}
+
+// Best-of-RUNS nanoseconds per sample through one process routine
+static double measure(MotionProcessFn process, const MotionConfig *prepared, const BenchData *data) {
+    double best = 0.0;
+    for (int run = 0; run < RUNS; run++) {
+        MotionState state;
+        motion_state_reset(&state);
+        long long total = 0;
+
+        uint64_t start = now_ns();
+        for (size_t i = 0; i < data->count; i++) {
+            MotionOutput out;
+            process(&state, prepared, &data->samples[i], &out);
+            total += out.move_x + out.move_y + out.scroll;
+        }
+        double ns = (double)(now_ns() - start) / data->count;
+
+        sink += total;
+        if (run == 0 || ns < best) best = ns;
+    }
+    return best;
+}
+
+// Best-of-RUNS nanoseconds per sample through the batch API
+static double measure_batch(const MouseConfig *config, const BenchData *data, MotionBatchOutput *out) {
+    double best = 0.0;
+    for (int run = 0; run < RUNS; run++) {
+        MotionState state;
+        motion_state_reset(&state);
+
+        uint64_t start = now_ns();
+        size_t produced = motion_process_batch(&state, config, &data->batch, out);
+        double ns = (double)(now_ns() - start) / data->count;
+
+        sink += produced;
+        if (run == 0 || ns < best) best = ns;
+    }
+    return best;
+}
+
+static void bench_config(const char *signal, const char *name, const MouseConfig *config,
+                         const BenchData *data, MotionBatchOutput *out) {
+    MotionConfig prepared;
+    motion_config_prepare(&prepared, config);
+
+    // Before specialization a zero deadzone or smoothing still ran
+    MotionConfig baseline = prepared;
+    if (!(baseline.stages & MOTION_STAGE_ABSOLUTE)) {
+        baseline.stages |= MOTION_STAGE_DEADZONE | MOTION_STAGE_SMOOTHING;
+    }
+
+    double generic = measure(motion_process_generic, &baseline, data);
+    double specialized = measure(prepared.process, &prepared, data);
+    double batch = measure_batch(config, data, out);
+    printf("bench=motion signal=%s config=%s stages=0x%02x routine=generic ns_per_sample=%.2f\n",
+           signal, name, prepared.stages, generic);
+    printf("bench=motion signal=%s config=%s stages=0x%02x routine=specialized ns_per_sample=%.2f speedup=%.2f\n",
+           signal, name, prepared.stages, specialized, specialized > 0.0 ? generic / specialized : 0.0);
+    printf("bench=motion signal=%s config=%s stages=0x%02x routine=batch ns_per_sample=%.2f speedup=%.2f\n",
+           signal, name, prepared.stages, batch, batch > 0.0 ? generic / batch : 0.0);
+}
+
+int main(int argc, char *argv[]) {
+    size_t count = argc > 1 ? strtoul(argv[1], NULL, 10) : DEFAULT_SAMPLES;
+    if (count == 0) {
+        fprintf(stderr, "Usage: %s [SAMPLES]\n", argv[0]);
+        return 1;
+    }
+
+    BenchData data = { .count = count };
+    data.packets = malloc(count * IMU_SYNTH_PACKET_SIZE);
+    data.ts = malloc(count * sizeof(uint32_t));
+    data.samples = malloc(count * sizeof(MotionSample));
+    float *columns = malloc(7 * count * sizeof(float));
+    int *outputs = malloc(6 * count * sizeof(int));
+    if (!data.packets || !data.ts || !data.samples || !columns || !outputs) {
+        perror("Failed to allocate samples");
+        return 1;
+    }
+
+    data.batch = (MotionBatch){
+        .roll = columns, .pitch = columns + count, .yaw = columns + 2 * count,
+        .quat_w = columns + 3 * count, .quat_x = columns + 4 * count,
+        .quat_y = columns + 5 * count, .quat_z = columns + 6 * count,
+        .ts = data.ts, .count = count
+    };
+    MotionBatchOutput out = {
+        .move_x = outputs, .move_y = outputs + count, .scroll = outputs + 2 * count,
+        .abs_x = outputs + 3 * count, .abs_y = outputs + 4 * count,
+        .scroll_hires = outputs + 5 * count
+    };
+
+    // Shipped defaults: no deadzone, no smoothing, Euler angles
+    MouseConfig defaults = {
+        .sensitivity_yaw = 45.0f,
+        .sensitivity_pitch = 45.0f,
+        .imu_rate = RATE,
+        .filter = FILTER_LEGACY,
+        .euro_min_cutoff = 1.0f,
+        .euro_beta = 0.2f,
+        .roll_scroll_threshold = 10.0f,
+        .scroll_hysteresis = 3.0f,
+        .scroll_speed = 12.0f,
+        .scroll_curve = 1.0f,
+        .scroll_max_speed = 40.0f,
+        .yaw_range = 60.0f,
+        .pitch_range = 40.0f,
+    };
+
+    // Every relative-mode stage on
+    MouseConfig full = defaults;
+    full.use_quaternion = true;
+    full.deadzone_speed = 3.0f;
+    full.smoothing_ms = 30.0f;
+    full.prediction_ms = 20.0f;
+    full.invert_x = true;
+
+    for (int signal = 0; signal < IMU_SYNTH_COUNT; signal++) {
+        const char *name = imu_synth_name((ImuSynthSignal)signal);
+        imu_synth_generate((ImuSynthSignal)signal, RATE, data.packets, IMU_SYNTH_PACKET_SIZE,
+                           data.ts, count);
+
+        printf("bench=motion signal=%s routine=decode ns_per_sample=%.2f\n",
+               name, measure_decode(&data));
+        printf("bench=motion signal=%s routine=decode_batch ns_per_sample=%.2f\n",
+               name, measure_decode_batch(&data));
+
+        bench_config(name, "default", &defaults, &data, &out);
+        bench_config(name, "full", &full, &data, &out);
+    }
+
+    free(outputs);
+    free(columns);
+    free(data.samples);
+    free(data.ts);
+    free(data.packets);
+    return 0;
+}
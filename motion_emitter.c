@@ -0,0 +1,372 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <poll.h>
+#include <sched.h>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+
+#include "motion_emitter.h"
+
+#define RING_MASK (EMITTER_RING_SIZE - 1)
+
+// Serializes config publishers
+static pthread_mutex_t publish_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static void futex_wait(atomic_uint *word, unsigned int expected) {
+    syscall(SYS_futex, word, FUTEX_WAIT_PRIVATE, expected, NULL, NULL, 0);
+}
+
+static void futex_wake(atomic_uint *word) {
+    syscall(SYS_futex, word, FUTEX_WAKE_PRIVATE, 1, NULL, NULL, 0);
+}
+
+// Wake the emitter if it announced it is going to sleep
+static void wake_emitter(MotionEmitter *emitter) {
+    if (atomic_load(&emitter->waiting) && atomic_exchange(&emitter->waiting, 0)) {
+        futex_wake(&emitter->waiting);
+    }
+}
+
+// Interrupt the wait for an output tick
+static void wake_resampler(MotionEmitter *emitter) {
+    uint64_t one = 1;
+    if (write(emitter->wake_fd, &one, sizeof(one)) < 0) {
+        perror("Failed to wake emitter");
+    }
+}
+
+// Start reading the published config. Announcing it in in_use before
+// re-checking active means a publisher that swapped in between either sees
+// our announcement and waits, or we see its new config.
+static const MotionConfig* acquire_config(MotionEmitter *emitter) {
+    MotionConfig *config = atomic_load(&emitter->active);
+    for (;;) {
+        atomic_store(&emitter->in_use, config);
+        MotionConfig *current = atomic_load(&emitter->active);
+        if (current == config) return config;
+        config = current;
+    }
+}
+
+// Stop reading the config. With nothing held, a copy retired by a publisher
+// can't be in use any more, so free it here.
+static void release_config(MotionEmitter *emitter) {
+    atomic_store(&emitter->in_use, NULL);
+    free(atomic_exchange(&emitter->retired, NULL));
+}
+
+// Path delay for resampling: one input interval, so a tick normally has a
+// sample on either side of the point it renders
+static uint64_t resample_delay_ns(const MouseConfig *config) {
+    int rate = config->imu_rate > 0 ? config->imu_rate : IMU_RATE_DEFAULT;
+    return 1000000000ull / rate;
+}
+
+// Process everything currently queued. Normally the outputs are summed and
+// emitted at once; on an output tick they go through the resampler instead,
+// which emits this tick's share (even when nothing new was queued).
+static unsigned int drain(MotionEmitter *emitter, bool tick) {
+    unsigned int tail = atomic_load_explicit(&emitter->tail, memory_order_relaxed);
+    unsigned int head = atomic_load_explicit(&emitter->head, memory_order_acquire);
+    unsigned int depth = head - tail;
+    if (depth == 0 && !tick) return 0;
+
+    if (depth > 0 && atomic_exchange(&emitter->reset_requested, false)) {
+        motion_state_reset(&emitter->state);
+    }
+    
+    // One config for the whole batch
+    const MotionConfig *config = acquire_config(emitter);
+
+    MotionOutput total = {0};
+    for (unsigned int i = tail; i != head; i++) {
+        const MotionSample *sample = &emitter->ring[i & RING_MASK];
+        MotionOutput out;
+
+        if (emitter->trace) {
+            emitter->trace(sample);
+        }
+        bool produced = motion_process_prepared(&emitter->state, config, sample, &out);
+        if (tick) {
+            motion_resampler_add(&emitter->resampler, sample->arrival_ns, &out);
+        } else if (produced) {
+            total.move_x += out.move_x;
+            total.move_y += out.move_y;
+            total.scroll += out.scroll;
+            total.scroll_hires += out.scroll_hires;
+            if (out.absolute) {
+                // Positions don't add up, the newest one wins
+                total.absolute = true;
+                total.abs_x = out.abs_x;
+                total.abs_y = out.abs_y;
+            }
+        }
+    }
+
+    bool moved;
+    if (tick) {
+        moved = motion_resampler_tick(&emitter->resampler, latency_now_ns(),
+                                      resample_delay_ns(&config->config), &total);
+        atomic_fetch_add_explicit(&emitter->ticks, 1, memory_order_relaxed);
+        atomic_fetch_add_explicit(&emitter->resampled, depth, memory_order_relaxed);
+        if (depth == 0) {
+            if (moved) emitter->emit(&total);
+            release_config(emitter);
+            return 0;
+        }
+    } else {
+        moved = total.move_x != 0 || total.move_y != 0 || total.scroll_hires != 0 || total.absolute;
+    }
+
+    if (moved) {
+        emitter->emit(&total);
+
+        // Slots stay ours until tail is released, so arrival times are still valid
+        uint64_t now = latency_now_ns();
+        for (unsigned int i = tail; i != head; i++) {
+            latency_histogram_record(&emitter->emit_latency, now - emitter->ring[i & RING_MASK].arrival_ns);
+        }
+    }
+    release_config(emitter);
+    atomic_store_explicit(&emitter->tail, head, memory_order_release);
+
+    atomic_fetch_add_explicit(&emitter->batches, 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&emitter->coalesced, depth - 1, memory_order_relaxed);
+    if (depth > atomic_load_explicit(&emitter->max_depth, memory_order_relaxed)) {
+        atomic_store_explicit(&emitter->max_depth, depth, memory_order_relaxed);
+    }
+    return depth;
+}
+
+// Emit whatever the resampler still holds, under the current config like
+// any other emit
+static void flush_resampler(MotionEmitter *emitter) {
+    MotionOutput rest;
+    if (motion_resampler_flush(&emitter->resampler, &rest)) {
+        acquire_config(emitter);
+        emitter->emit(&rest);
+        release_config(emitter);
+    }
+}
+
+// Arm the output timer at rate Hz, or disarm it for rate 0
+static void set_output_rate(MotionEmitter *emitter, int rate) {
+    if (emitter->timer_fd < 0) {
+        emitter->timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC);
+        if (emitter->timer_fd < 0) {
+            perror("Failed to create output timer");
+            return;
+        }
+    }
+
+    if (emitter->timer_rate > 0) {
+        flush_resampler(emitter);
+    }
+    if (rate > 0) {
+        motion_resampler_reset(&emitter->resampler);
+    }
+
+    // At 1 Hz the period is a whole second, which tv_nsec can't hold
+    long long period_ns = rate > 0 ? 1000000000LL / rate : 0;
+    struct timespec period = { .tv_sec = period_ns / 1000000000LL, .tv_nsec = period_ns % 1000000000LL };
+    struct itimerspec spec = { .it_interval = period, .it_value = period };
+    if (timerfd_settime(emitter->timer_fd, 0, &spec, NULL) < 0) {
+        perror("Failed to arm output timer");
+        return;
+    }
+    emitter->timer_rate = rate;
+}
+
+// Emitter thread
+static void* emitter_thread(void *arg) {
+    MotionEmitter *emitter = (MotionEmitter *)arg;
+
+    while (atomic_load(&emitter->running)) {
+        int rate = acquire_config(emitter)->config.output_rate;
+        release_config(emitter);
+        if (rate != emitter->timer_rate) {
+            set_output_rate(emitter, rate);
+        }
+
+        // Resampled output: one frame per timer tick, pushes don't wake us.
+        // A wakeup just goes round again to pick up a new config or stop.
+        if (emitter->timer_rate > 0) {
+            struct pollfd fds[2] = {
+                { .fd = emitter->timer_fd, .events = POLLIN },
+                { .fd = emitter->wake_fd, .events = POLLIN }
+            };
+            if (poll(fds, 2, -1) < 0) continue;
+            
+            uint64_t count;
+            if ((fds[1].revents & POLLIN) &&
+                read(emitter->wake_fd, &count, sizeof(count)) < 0 && errno != EAGAIN) {
+                perror("Failed to read emitter eventfd");
+            }
+            if ((fds[0].revents & POLLIN) &&
+                read(emitter->timer_fd, &count, sizeof(count)) == sizeof(count)) {
+                drain(emitter, true);
+            }
+            continue;
+        }
+
+        if (drain(emitter, false) > 0) continue;
+
+        // Announce we're going to sleep, then re-check so a push or a new
+        // output rate that raced with the announcement isn't missed
+        atomic_store(&emitter->waiting, 1);
+        int fresh_rate = acquire_config(emitter)->config.output_rate;
+        release_config(emitter);
+        if (atomic_load(&emitter->head) != atomic_load(&emitter->tail) ||
+            !atomic_load(&emitter->running) || fresh_rate != rate) {
+            atomic_store(&emitter->waiting, 0);
+            continue;
+        }
+        futex_wait(&emitter->waiting, 1);
+    }
+
+    // Flush anything queued before stop was requested
+    if (emitter->timer_rate > 0) {
+        drain(emitter, true);
+        flush_resampler(emitter);
+    } else {
+        drain(emitter, false);
+    }
+    if (emitter->timer_fd >= 0) {
+        close(emitter->timer_fd);
+        emitter->timer_fd = -1;
+    }
+    return NULL;
+}
+
+void motion_emitter_set_config(MotionEmitter *emitter, const MouseConfig *config) {
+    pthread_mutex_lock(&publish_lock);
+    
+    // Console commands like status republish an unchanged config
+    MotionConfig *current = atomic_load(&emitter->active);
+    if (current && memcmp(&current->config, config, sizeof(*config)) == 0) {
+        pthread_mutex_unlock(&publish_lock);
+        return;
+    }
+    
+    MotionConfig *fresh = malloc(sizeof(*fresh));
+    if (!fresh) {
+        perror("Failed to allocate config");
+        pthread_mutex_unlock(&publish_lock);
+        return;
+    }
+    motion_config_prepare(fresh, config);
+    MotionConfig *old = atomic_exchange(&emitter->active, fresh);
+    
+    // The emitter can't pick up old any more, only keep reading it if it
+    // already is. Then it frees it after the batch; since it reads one config
+    // at a time, whatever was retired before can't be in use.
+    if (old && atomic_load(&emitter->in_use) == old) {
+        old = atomic_exchange(&emitter->retired, old);
+    }
+    pthread_mutex_unlock(&publish_lock);
+    free(old);
+    
+    // The emitter may be waiting out a long tick, or asleep between samples
+    // (stream stopped), and has to switch to the new output rate now
+    if (atomic_load(&emitter->running)) {
+        wake_resampler(emitter);
+        wake_emitter(emitter);
+    }
+}
+
+const MouseConfig* motion_emitter_config(MotionEmitter *emitter) {
+    return &atomic_load_explicit(&emitter->in_use, memory_order_relaxed)->config;
+}
+
+// Start the emitter thread
+bool motion_emitter_start(MotionEmitter *emitter) {
+    motion_state_reset(&emitter->state);
+    atomic_store(&emitter->reset_requested, false);
+    atomic_store(&emitter->head, 0);
+    atomic_store(&emitter->tail, 0);
+    atomic_store(&emitter->waiting, 0);
+    motion_resampler_reset(&emitter->resampler);
+    emitter->timer_fd = -1;
+    emitter->timer_rate = 0;
+
+    emitter->wake_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (emitter->wake_fd < 0) {
+        perror("Failed to create emitter eventfd");
+        return false;
+    }
+    atomic_store(&emitter->running, true);
+    if (pthread_create(&emitter->thread, NULL, emitter_thread, emitter) != 0) {
+        perror("Failed to create emitter thread");
+        atomic_store(&emitter->running, false);
+        close(emitter->wake_fd);
+        return false;
+    }
+    return true;
+}
+
+// Stop the emitter thread
+void motion_emitter_stop(MotionEmitter *emitter) {
+    if (!atomic_exchange(&emitter->running, false)) return;
+
+    atomic_store(&emitter->waiting, 0);
+    futex_wake(&emitter->waiting);
+    wake_resampler(emitter);
+    pthread_join(emitter->thread, NULL);
+    close(emitter->wake_fd);
+    
+    free(atomic_exchange(&emitter->active, NULL));
+    free(atomic_exchange(&emitter->retired, NULL));
+}
+
+// Queue a sample (SDK thread)
+bool motion_emitter_push(MotionEmitter *emitter, const MotionSample *sample) {
+    unsigned int head = atomic_load_explicit(&emitter->head, memory_order_relaxed);
+
+    while (head - atomic_load_explicit(&emitter->tail, memory_order_acquire) >= EMITTER_RING_SIZE) {
+        if (!emitter->lossless || !atomic_load(&emitter->running)) {
+            // Samples carry absolute orientation, so the next one still
+            // covers this one's motion
+            atomic_fetch_add_explicit(&emitter->dropped, 1, memory_order_relaxed);
+            wake_emitter(emitter);
+            return false;
+        }
+        wake_emitter(emitter);
+        sched_yield();
+    }
+
+    emitter->ring[head & RING_MASK] = *sample;
+    atomic_store(&emitter->head, head + 1);
+    atomic_fetch_add_explicit(&emitter->samples, 1, memory_order_relaxed);
+
+    wake_emitter(emitter);
+    return true;
+}
+
+void motion_emitter_reset(MotionEmitter *emitter) {
+    atomic_store(&emitter->reset_requested, true);
+}
+
+void motion_emitter_format_stats(MotionEmitter *emitter, char *buffer, size_t size) {
+    unsigned int depth = atomic_load(&emitter->head) - atomic_load(&emitter->tail);
+    unsigned long long ticks = atomic_load(&emitter->ticks);
+    unsigned long long resampled = atomic_load(&emitter->resampled);
+
+    // Input samples per output frame while resampling
+    snprintf(buffer, size,
+             "queue_depth=%u max_depth=%u samples=%llu batches=%llu coalesced=%llu dropped=%llu"
+             " ticks=%llu resample_ratio=%.2f",
+             depth,
+             atomic_load(&emitter->max_depth),
+             atomic_load(&emitter->samples),
+             atomic_load(&emitter->batches),
+             atomic_load(&emitter->coalesced),
+             atomic_load(&emitter->dropped),
+             ticks,
+             ticks ? (double)resampled / ticks : 0.0);
+}
@@ -0,0 +1,102 @@
+#ifndef MOTION_EMITTER_H
+#define MOTION_EMITTER_H
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <pthread.h>
+
+#include "mouse_config.h"
+#include "motion_pipeline.h"
+#include "motion_resampler.h"
+#include "latency_histogram.h"
+
+// Samples buffered between the SDK callback and the emitter thread (power of two)
+#define EMITTER_RING_SIZE 256
+
+// Decouples the SDK callback thread from event emission. The callback pushes
+// decoded samples into a single-producer/single-consumer ring; a dedicated
+// thread runs them through the motion pipeline and emits the result. When the
+// emitter falls behind, everything queued is processed in one go and the
+// outputs are summed into a single emit, so motion is never lost.
+//
+// The configuration is published RCU-style: motion_emitter_set_config prepares
+// a fresh MotionConfig and swaps it in with one atomic store, so the emitter
+// thread never sees a half-updated config and never takes a lock. Publishers
+// never wait for the emitter either: an old copy it is still reading is
+// retired, and the emitter frees it when it finishes that batch.
+//
+// With output_rate set, the thread instead wakes on a timerfd at that
+// rate and emits exactly one frame per tick, resampled from the sample stream
+// (see motion_resampler.h). Stopping and publishing a config wake it between
+// ticks, so a slow output rate doesn't hold either up, and a new output rate
+// takes effect even while no samples arrive.
+typedef struct {
+    // Set before motion_emitter_start
+    void (*emit)(const MotionOutput *out);      // Called on the emitter thread
+    void (*trace)(const MotionSample *sample);  // Optional, called on the emitter thread
+    bool lossless;              // Producer waits for space instead of dropping (replay)
+
+    // Published configuration, the copy the emitter thread is reading, and a
+    // replaced copy left for the emitter to free
+    _Atomic(MotionConfig *) active;
+    _Atomic(MotionConfig *) in_use;
+    _Atomic(MotionConfig *) retired;
+
+    // Pipeline state, only touched by the emitter thread
+    MotionState state;
+    atomic_bool reset_requested;
+
+    // Ring buffer: head is written by the producer, tail by the consumer
+    MotionSample ring[EMITTER_RING_SIZE];
+    _Alignas(64) atomic_uint head;
+    _Alignas(64) atomic_uint tail;
+    atomic_uint waiting;        // Futex word, set while the emitter sleeps
+
+    pthread_t thread;
+    atomic_bool running;
+
+    // Output resampling, only touched by the emitter thread
+    MotionResampler resampler;
+    int timer_fd;
+    int timer_rate;             // Rate the timer is armed at, 0 = disarmed
+    int wake_fd;                // eventfd that interrupts the wait for a tick
+
+    // Statistics
+    atomic_ullong samples;      // Samples pushed
+    atomic_ullong dropped;      // Samples dropped because the ring was full
+    atomic_ullong batches;      // Emitter wakeups that processed samples
+    atomic_ullong coalesced;    // Samples folded into another sample's emit
+    atomic_uint max_depth;      // Deepest queue seen by the emitter
+    atomic_ullong ticks;        // Output ticks while resampling
+    atomic_ullong resampled;    // Samples consumed while resampling
+
+    // Sample arrival to emit() returning, for every sample in an emitted batch
+    LatencyHistogram emit_latency;
+} MotionEmitter;
+
+// Publish a new configuration; call at least once before motion_emitter_start.
+// Safe from any thread and never blocks on the emitter. A config identical to
+// the published one is ignored.
+void motion_emitter_set_config(MotionEmitter *emitter, const MouseConfig *config);
+
+// The configuration of the sample being processed, for the emit and trace
+// callbacks (only valid inside them)
+const MouseConfig* motion_emitter_config(MotionEmitter *emitter);
+
+bool motion_emitter_start(MotionEmitter *emitter);
+
+// Drain whatever is queued, then stop the emitter thread
+void motion_emitter_stop(MotionEmitter *emitter);
+
+// Queue a sample from the SDK thread. Never blocks unless lossless is set.
+bool motion_emitter_push(MotionEmitter *emitter, const MotionSample *sample);
+
+// Ask the emitter thread to re-initialize its reference orientation
+void motion_emitter_reset(MotionEmitter *emitter);
+
+// Format queue and coalescing statistics as key=value pairs
+void motion_emitter_format_stats(MotionEmitter *emitter, char *buffer, size_t size);
+
+#endif // MOTION_EMITTER_H
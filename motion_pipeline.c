@@ -0,0 +1,719 @@
+#include <string.h>
+#include <math.h>
+
+#include "motion_pipeline.h"
+
+// Convert big-endian byte array to float (same result as the SDK example's
+// byte-reversing makeFloat, but written so the compiler can vectorize it)
+static inline float makeFloat(const uint8_t *data)
+{
+    uint32_t bits;
+    float value;
+    memcpy(&bits, data, 4);
+    bits = __builtin_bswap32(bits);
+    memcpy(&value, &bits, 4);
+    return value;
+}
+
+// Handle angle wrap-around (yaw goes from -180 to 180)
+static inline float wrap_delta(float delta)
+{
+    float below = delta - 360.0f;
+    float above = delta + 360.0f;
+    delta = delta > 180.0f ? below : delta;
+    return delta < -180.0f ? above : delta;
+}
+
+// Apply dead zone with smooth transition
+static inline float apply_deadzone(float delta, float deadzone)
+{
+    float magnitude = fabsf(delta) - deadzone;
+    magnitude = magnitude > 0.0f ? magnitude : 0.0f;
+    return copysignf(magnitude, delta);
+}
+
+// Yaw and pitch of the rotation from previous to current orientation, in the
+// head's own frame. Because the delta is taken in the head frame, turning the
+// head while it is rolled moves the cursor along the rolled screen's axes
+// instead of leaking yaw into pitch. Small-angle approximation: no trig, and
+// the sign of w picks the shorter of the two equivalent rotations.
+static inline void quaternion_delta(float pw, float px, float py, float pz,
+                                    float cw, float cx, float cy, float cz,
+                                    float *delta_yaw, float *delta_pitch)
+{
+    // relative = conjugate(previous) * current
+    float rw = pw * cw + px * cx + py * cy + pz * cz;
+    float ry = pw * cy + px * cz - py * cw - pz * cx;
+    float rz = pw * cz - px * cy + py * cx - pz * cw;
+    float scale = copysignf(QUAT_TO_DEGREES, rw);
+
+    *delta_yaw = rz * scale;
+    *delta_pitch = ry * scale;
+}
+
+// Alpha-beta gains for the pose estimate used by prediction. beta follows
+// alpha^2 / (2 - alpha), which keeps the filter critically damped.
+#define PREDICT_ALPHA 0.5f
+#define PREDICT_BETA  0.1667f
+
+// Seconds since the previous sample. Sample times are used when both samples
+// have one: they follow the rate the glasses actually stream at, where the
+// SDK's millisecond timestamps are off by up to a quarter of a 240 Hz
+// interval. Samples without them (synthesized, or decoded by a tool) fall
+// back to ts, and to the nominal interval when that didn't advance. Samples
+// delivered back to back count as at least a quarter of the nominal
+// interval, so a burst from the USB stack doesn't read as a jump in speed.
+static inline float sample_interval(MotionState *state, uint32_t ts, uint64_t time_ns, float nominal)
+{
+    uint32_t elapsed_ms = ts - state->last_ts;
+    uint64_t last_time_ns = state->last_time_ns;
+    state->last_ts = ts;
+    state->last_time_ns = time_ns;
+
+    if (time_ns && last_time_ns) {
+        float elapsed = (time_ns - last_time_ns) * 1e-9f;
+        return fmaxf(elapsed, nominal * 0.25f);
+    }
+    return elapsed_ms ? elapsed_ms * 0.001f : nominal;
+}
+
+// Cutoff for the One Euro filter's speed estimate (Hz)
+#define EURO_DERIVATIVE_CUTOFF 1.0f
+
+// Roll below which scrolling stops. If the threshold was lowered to or below
+// the hysteresis after it was set, nothing would be left to release at, so
+// scrolling stops at half the threshold instead.
+static inline float scroll_release(const MouseConfig *config)
+{
+    float release = config->roll_scroll_threshold - config->scroll_hysteresis;
+    return release > 0.0f ? release : config->roll_scroll_threshold * 0.5f;
+}
+
+static inline MotionParams motion_params(const MouseConfig *config)
+{
+    float interval = config->imu_rate > 0 ? 1.0f / config->imu_rate : MOTION_NOMINAL_INTERVAL;
+    float smoothing = 0.0f;
+
+    // The legacy smoothing only applies when One Euro is off
+    if (config->filter == FILTER_LEGACY && config->smoothing_ms > 0.0f) {
+        smoothing = expf(-interval * 1000.0f / config->smoothing_ms);
+    }
+
+    MotionParams params = {
+        .interval = interval,
+        .use_quaternion = config->use_quaternion,
+        .deadzone = config->deadzone_speed * interval,
+        .smoothing = smoothing,
+        .gain_x = config->invert_x ? -config->sensitivity_yaw : config->sensitivity_yaw,
+        .gain_y = config->invert_y ? -config->sensitivity_pitch : config->sensitivity_pitch,
+        .scroll_threshold = config->roll_scroll_threshold,
+        .scroll_release = scroll_release(config),
+        .scroll_gain = (config->invert_scroll ? -config->scroll_speed : config->scroll_speed) * interval,
+        .scroll_curve = config->scroll_curve > 0.0f ? config->scroll_curve : 1.0f,
+        .scroll_max = config->scroll_max_speed * interval,
+        .one_euro = config->filter == FILTER_ONE_EURO,
+        .min_cutoff = config->euro_min_cutoff,
+        .beta = config->euro_beta,
+        .horizon = config->prediction_ms * 0.001f,
+        .absolute = config->absolute_mode,
+        .abs_scale_x = (config->invert_x ? -1.0f : 1.0f) / config->yaw_range,
+        .abs_scale_y = (config->invert_y ? -1.0f : 1.0f) / config->pitch_range,
+    };
+    return params;
+}
+
+static inline bool pose_stage_active(const MotionParams *params)
+{
+    return params->one_euro || params->horizon > 0.0f || params->absolute;
+}
+
+// Smoothing factor of a first-order low-pass at cutoff Hz over dt seconds
+static inline float lowpass_alpha(float cutoff, float dt)
+{
+    float tau = 1.0f / (6.28318531f * cutoff);     // 1 / (2 pi fc)
+    return dt / (dt + tau);
+}
+
+// One Euro filter: a low-pass whose cutoff rises with head speed, so the
+// pose is heavily smoothed at rest and barely delayed during fast turns.
+// Both axes share one cutoff from the combined speed so diagonal motion
+// isn't bent toward the faster axis.
+static inline void one_euro(MotionState *state, const MotionParams *params, float dt,
+                            float delta_yaw, float delta_pitch,
+                            float *pose_yaw, float *pose_pitch)
+{
+    float speed_alpha = lowpass_alpha(EURO_DERIVATIVE_CUTOFF, dt);
+    state->euro_speed_yaw += speed_alpha * (delta_yaw / dt - state->euro_speed_yaw);
+    state->euro_speed_pitch += speed_alpha * (delta_pitch / dt - state->euro_speed_pitch);
+
+    float speed = sqrtf(state->euro_speed_yaw * state->euro_speed_yaw +
+                        state->euro_speed_pitch * state->euro_speed_pitch);
+    float alpha = lowpass_alpha(params->min_cutoff + params->beta * speed, dt);
+    state->euro_yaw += alpha * (*pose_yaw - state->euro_yaw);
+    state->euro_pitch += alpha * (*pose_pitch - state->euro_pitch);
+
+    *pose_yaw = state->euro_yaw;
+    *pose_pitch = state->euro_pitch;
+}
+
+// Alpha-beta estimate of the pose, extrapolated horizon seconds ahead
+static inline void predict(MotionState *state, float horizon, float dt,
+                           float *pose_yaw, float *pose_pitch)
+{
+    float guess_yaw = state->est_yaw + state->vel_yaw * dt;
+    float guess_pitch = state->est_pitch + state->vel_pitch * dt;
+    float error_yaw = *pose_yaw - guess_yaw;
+    float error_pitch = *pose_pitch - guess_pitch;
+
+    state->est_yaw = guess_yaw + PREDICT_ALPHA * error_yaw;
+    state->est_pitch = guess_pitch + PREDICT_ALPHA * error_pitch;
+    state->vel_yaw += PREDICT_BETA * error_yaw / dt;
+    state->vel_pitch += PREDICT_BETA * error_pitch / dt;
+
+    *pose_yaw = state->est_yaw + state->vel_yaw * horizon;
+    *pose_pitch = state->est_pitch + state->vel_pitch * horizon;
+}
+
+// Feed one sample's movement into the head pose, run the pose through the
+// One Euro filter and/or prediction, and replace the movement with that of
+// the resulting pose. Both stages converge on the real pose whenever the
+// head stops, so the summed output never drifts from the summed input.
+static inline void pose_stage(MotionState *state, const MotionParams *params, float dt,
+                              float *delta_yaw, float *delta_pitch)
+{
+    state->pose_yaw += *delta_yaw;
+    state->pose_pitch += *delta_pitch;
+    float target_yaw = state->pose_yaw;
+    float target_pitch = state->pose_pitch;
+
+    if (dt > MOTION_MAX_INTERVAL) {
+        // Too long a gap to trust the old speed and velocity
+        state->euro_yaw = state->est_yaw = state->pose_yaw;
+        state->euro_pitch = state->est_pitch = state->pose_pitch;
+        state->euro_speed_yaw = state->euro_speed_pitch = 0.0f;
+        state->vel_yaw = state->vel_pitch = 0.0f;
+    } else {
+        if (params->one_euro) {
+            one_euro(state, params, dt, *delta_yaw, *delta_pitch, &target_yaw, &target_pitch);
+        }
+        if (params->horizon > 0.0f) {
+            predict(state, params->horizon, dt, &target_yaw, &target_pitch);
+        }
+    }
+
+    *delta_yaw = target_yaw - state->output_yaw;
+    *delta_pitch = target_pitch - state->output_pitch;
+    state->output_yaw = target_yaw;
+    state->output_pitch = target_pitch;
+}
+
+// Map the pose stage's output (degrees from center) to a screen position,
+// clamped to the screen edges. Only reports positions that changed.
+static inline bool absolute_position(MotionState *state, const MotionParams *params,
+                                     MotionOutput *out)
+{
+    float x = 0.5f + state->output_yaw * params->abs_scale_x;
+    float y = 0.5f + state->output_pitch * params->abs_scale_y;
+    x = x < 0.0f ? 0.0f : (x > 1.0f ? 1.0f : x);
+    y = y < 0.0f ? 0.0f : (y > 1.0f ? 1.0f : y);
+
+    out->abs_x = (int)(x * MOTION_ABS_MAX + 0.5f);
+    out->abs_y = (int)(y * MOTION_ABS_MAX + 0.5f);
+    out->absolute = out->abs_x != state->last_abs_x || out->abs_y != state->last_abs_y;
+    state->last_abs_x = out->abs_x;
+    state->last_abs_y = out->abs_y;
+    return out->absolute;
+}
+
+// Fractional scroll clicks for a roll angle, positive scrolls up. The rate
+// grows with the degrees past the threshold raised to the curve, up to the
+// limit. Inversion is folded into the sign of the gain.
+static inline float scroll_amount(float roll, const MotionParams *params)
+{
+    float excess = fabsf(roll) - params->scroll_threshold;
+    if (excess <= 0.0f) return 0.0f;
+    if (params->scroll_curve != 1.0f) {
+        excess = powf(excess, params->scroll_curve);
+    }
+
+    float amount = excess * params->scroll_gain;
+    if (params->scroll_max > 0.0f) {
+        amount = fmaxf(-params->scroll_max, fminf(amount, params->scroll_max));
+    }
+
+    // Set direction based on roll
+    return roll > 0.0f ? amount : -amount;
+}
+
+// Collect fractional scroll as high-resolution units, and release a whole
+// click for every MOTION_SCROLL_HIRES of them. Scrolling starts past the
+// threshold but only stops below the release angle, so hovering around the
+// threshold doesn't keep throwing the remainder away. Returns the
+// high-resolution units.
+static inline int scroll_units(MotionState *state, const MotionParams *params, float roll,
+                               float amount, int *clicks)
+{
+    float tilt = fabsf(roll);
+    if (tilt > params->scroll_threshold) {
+        state->scrolling = true;
+    } else if (tilt < params->scroll_release) {
+        state->scrolling = false;
+    }
+    if (!state->scrolling) {
+        state->accum_scroll = 0.0f;
+        state->scroll_detent = 0;
+        *clicks = 0;
+        return 0;
+    }
+
+    float total = state->accum_scroll + amount * MOTION_SCROLL_HIRES;
+    int units = (int)total;
+    state->accum_scroll = total - units;
+    state->scroll_detent += units;
+    *clicks = state->scroll_detent / MOTION_SCROLL_HIRES;
+    state->scroll_detent -= *clicks * MOTION_SCROLL_HIRES;
+    return units;
+}
+
+// Apply smoothing and move whole pixels out of the sub-pixel accumulators.
+// With smooth false the blend is skipped; that's what a smoothing factor of
+// zero computes anyway.
+static inline __attribute__((always_inline)) void accumulate(MotionState *state, bool smooth,
+                                                             float smoothing, float dx, float dy,
+                                                             int *move_x, int *move_y)
+{
+    if (smooth) {
+        dx = dx * (1.0f - smoothing) + state->last_dx * smoothing;
+        dy = dy * (1.0f - smoothing) + state->last_dy * smoothing;
+    }
+    state->last_dx = dx;
+    state->last_dy = dy;
+
+    state->accum_x += dx;
+    state->accum_y += dy;
+
+    *move_x = (int)state->accum_x;
+    *move_y = (int)state->accum_y;
+
+    // Keep sub-pixel remainder
+    state->accum_x -= *move_x;
+    state->accum_y -= *move_y;
+}
+
+// Store the reference orientation from a sample
+static void init_reference(MotionState *state, const MotionSample *sample)
+{
+    state->last_yaw = sample->yaw;
+    state->last_pitch = sample->pitch;
+    state->last_roll = sample->roll;
+    state->last_quat_w = sample->quat_w;
+    state->last_quat_x = sample->quat_x;
+    state->last_quat_y = sample->quat_y;
+    state->last_quat_z = sample->quat_z;
+    state->center_yaw = sample->yaw;
+    state->center_pitch = sample->pitch;
+    state->last_abs_x = state->last_abs_y = -1;
+    state->last_ts = sample->ts;
+    state->last_time_ns = sample->time_ns;
+    state->pose_yaw = state->pose_pitch = 0.0f;
+    state->est_yaw = state->est_pitch = 0.0f;
+    state->vel_yaw = state->vel_pitch = 0.0f;
+    state->euro_yaw = state->euro_pitch = 0.0f;
+    state->euro_speed_yaw = state->euro_speed_pitch = 0.0f;
+    state->output_yaw = state->output_pitch = 0.0f;
+    state->last_dx = 0.0f;
+    state->last_dy = 0.0f;
+    state->accum_x = 0.0f;
+    state->accum_y = 0.0f;
+    state->accum_scroll = 0.0f;
+    state->scroll_detent = 0;
+    state->scrolling = false;
+    state->initialized = true;
+}
+
+void motion_state_reset(MotionState *state)
+{
+    state->initialized = false;
+}
+
+void motion_decode(const uint8_t *data, uint16_t len, uint32_t ts, MotionSample *sample)
+{
+    sample->roll = makeFloat(data + IMU_OFFSET_ROLL);
+    sample->pitch = makeFloat(data + IMU_OFFSET_PITCH);
+    sample->yaw = makeFloat(data + IMU_OFFSET_YAW);
+    sample->ts = ts;
+    sample->arrival_ns = 0;
+    sample->time_ns = 0;
+
+    // Quaternion data for more accurate orientation (if available)
+    sample->have_quaternion = len >= IMU_QUAT_MIN_LEN;
+    if (sample->have_quaternion) {
+        sample->quat_w = makeFloat(data + IMU_OFFSET_QUAT);
+        sample->quat_x = makeFloat(data + IMU_OFFSET_QUAT + 4);
+        sample->quat_y = makeFloat(data + IMU_OFFSET_QUAT + 8);
+        sample->quat_z = makeFloat(data + IMU_OFFSET_QUAT + 12);
+    } else {
+        sample->quat_w = 1.0f;
+        sample->quat_x = sample->quat_y = sample->quat_z = 0.0f;
+    }
+}
+
+// The whole per-sample pipeline. stages says which optional stages run; the
+// variants below pass it as a constant so each one is compiled with the
+// disabled stages removed, and motion_process_generic passes it at run time.
+static inline __attribute__((always_inline)) bool process_sample(MotionState *state,
+                                                                 const MotionParams *params,
+                                                                 const MotionSample *sample,
+                                                                 MotionOutput *out,
+                                                                 unsigned int stages)
+{
+    out->move_x = out->move_y = out->scroll = out->scroll_hires = 0;
+    out->absolute = false;
+
+    // Initialize reference position if needed
+    if (!state->initialized) {
+        init_reference(state, sample);
+        return false;
+    }
+
+    // Calculate relative movement
+    float delta_yaw, delta_pitch;
+    if ((stages & MOTION_STAGE_QUATERNION) && sample->have_quaternion) {
+        quaternion_delta(state->last_quat_w, state->last_quat_x, state->last_quat_y, state->last_quat_z,
+                         sample->quat_w, sample->quat_x, sample->quat_y, sample->quat_z,
+                         &delta_yaw, &delta_pitch);
+    } else {
+        delta_yaw = wrap_delta(sample->yaw - state->last_yaw);
+        delta_pitch = sample->pitch - state->last_pitch;
+    }
+
+    float dt = sample_interval(state, sample->ts, sample->time_ns, params->interval);
+    if (stages & MOTION_STAGE_POSE) {
+        pose_stage(state, params, dt, &delta_yaw, &delta_pitch);
+    }
+
+    if (stages & MOTION_STAGE_ABSOLUTE) {
+        absolute_position(state, params, out);
+    } else {
+        if (stages & MOTION_STAGE_DEADZONE) {
+            delta_yaw = apply_deadzone(delta_yaw, params->deadzone);
+            delta_pitch = apply_deadzone(delta_pitch, params->deadzone);
+        }
+
+        // Apply sensitivity, with inversion folded into the sign of the gain
+        float dx = delta_yaw * params->gain_x;
+        float dy = delta_pitch * params->gain_y;
+
+        accumulate(state, stages & MOTION_STAGE_SMOOTHING, params->smoothing, dx, dy,
+                   &out->move_x, &out->move_y);
+    }
+    out->scroll_hires = scroll_units(state, params, sample->roll, scroll_amount(sample->roll, params),
+                                     &out->scroll);
+
+    // Update state for next iteration
+    state->last_yaw = sample->yaw;
+    state->last_pitch = sample->pitch;
+    state->last_roll = sample->roll;
+    state->last_quat_w = sample->quat_w;
+    state->last_quat_x = sample->quat_x;
+    state->last_quat_y = sample->quat_y;
+    state->last_quat_z = sample->quat_z;
+
+    return out->move_x != 0 || out->move_y != 0 || out->scroll_hires != 0 || out->absolute;
+}
+
+// One specialized routine per combination of stages
+#define MOTION_VARIANT_LIST(X) \
+    X(0)  X(1)  X(2)  X(3)  X(4)  X(5)  X(6)  X(7)  \
+    X(8)  X(9)  X(10) X(11) X(12) X(13) X(14) X(15) \
+    X(16) X(17) X(18) X(19) X(20) X(21) X(22) X(23) \
+    X(24) X(25) X(26) X(27) X(28) X(29) X(30) X(31)
+
+#define MOTION_VARIANT(bits) \
+    static bool process_variant_##bits(MotionState *state, const MotionConfig *prepared, \
+                                       const MotionSample *sample, MotionOutput *out) \
+    { \
+        return process_sample(state, &prepared->params, sample, out, bits); \
+    }
+MOTION_VARIANT_LIST(MOTION_VARIANT)
+
+#define MOTION_VARIANT_ENTRY(bits) process_variant_##bits,
+static const MotionProcessFn process_variants[MOTION_VARIANTS] = {
+    MOTION_VARIANT_LIST(MOTION_VARIANT_ENTRY)
+};
+
+// Stages a set of parameters needs. A deadzone or smoothing of zero is the
+// identity, so those stages are left out rather than run with no effect.
+static unsigned int motion_stages(const MotionParams *params)
+{
+    unsigned int stages = 0;
+    if (params->use_quaternion) stages |= MOTION_STAGE_QUATERNION;
+    if (pose_stage_active(params)) stages |= MOTION_STAGE_POSE;
+    if (params->absolute) {
+        // Absolute positions bypass the deadzone and smoothing
+        stages |= MOTION_STAGE_ABSOLUTE;
+    } else {
+        if (params->deadzone > 0.0f) stages |= MOTION_STAGE_DEADZONE;
+        if (params->smoothing > 0.0f) stages |= MOTION_STAGE_SMOOTHING;
+    }
+    return stages;
+}
+
+void motion_config_prepare(MotionConfig *prepared, const MouseConfig *config)
+{
+    prepared->config = *config;
+    prepared->params = motion_params(config);
+    prepared->stages = motion_stages(&prepared->params);
+    prepared->process = process_variants[prepared->stages];
+}
+
+bool motion_process(MotionState *state, const MouseConfig *config,
+                    const MotionSample *sample, MotionOutput *out)
+{
+    MotionConfig prepared;
+    motion_config_prepare(&prepared, config);
+    return prepared.process(state, &prepared, sample, out);
+}
+
+bool motion_process_prepared(MotionState *state, const MotionConfig *prepared,
+                             const MotionSample *sample, MotionOutput *out)
+{
+    return prepared->process(state, prepared, sample, out);
+}
+
+bool motion_process_generic(MotionState *state, const MotionConfig *prepared,
+                            const MotionSample *sample, MotionOutput *out)
+{
+    return process_sample(state, &prepared->params, sample, out, prepared->stages);
+}
+
+MotionProcessFn motion_process_variant(unsigned int stages)
+{
+    return process_variants[stages % MOTION_VARIANTS];
+}
+
+// Vector pass: byte-swap big-endian words and reinterpret them as floats
+static void decode_words(const uint32_t *restrict words, size_t n, float *restrict out)
+{
+    for (size_t i = 0; i < n; i++) {
+        uint32_t bits = __builtin_bswap32(words[i]);
+        memcpy(&out[i], &bits, 4);
+    }
+}
+
+void motion_decode_batch(const uint8_t *packets, size_t stride, size_t count,
+                         MotionBatch *batch)
+{
+    uint32_t words[7][MOTION_BATCH_CHUNK];
+    float *out[7] = {
+        batch->roll, batch->pitch, batch->yaw,
+        batch->quat_w, batch->quat_x, batch->quat_y, batch->quat_z
+    };
+    static const size_t offsets[7] = {
+        IMU_OFFSET_ROLL, IMU_OFFSET_PITCH, IMU_OFFSET_YAW,
+        IMU_OFFSET_QUAT, IMU_OFFSET_QUAT + 4, IMU_OFFSET_QUAT + 8, IMU_OFFSET_QUAT + 12
+    };
+    size_t fields = (batch->quat_w && stride >= IMU_QUAT_MIN_LEN) ? 7 : 3;
+
+    for (size_t base = 0; base < count; base += MOTION_BATCH_CHUNK) {
+        size_t n = count - base;
+        if (n > MOTION_BATCH_CHUNK) n = MOTION_BATCH_CHUNK;
+
+        // Gather the raw words; the packet stride keeps this pass scalar
+        for (size_t i = 0; i < n; i++) {
+            const uint8_t *packet = packets + (base + i) * stride;
+            for (size_t f = 0; f < fields; f++) {
+                memcpy(&words[f][i], packet + offsets[f], 4);
+            }
+        }
+
+        for (size_t f = 0; f < fields; f++) {
+            decode_words(words[f], n, out[f] + base);
+        }
+    }
+    batch->count = count;
+}
+
+// Vector pass: per-sample deltas of an absolute angle, with optional wrap
+static void angle_deltas(const float *restrict angle, float previous, size_t n,
+                         bool wrap, float *restrict out)
+{
+    out[0] = angle[0] - previous;
+    for (size_t i = 1; i < n; i++) {
+        out[i] = angle[i] - angle[i - 1];
+    }
+    if (wrap) {
+        for (size_t i = 0; i < n; i++) {
+            out[i] = wrap_delta(out[i]);
+        }
+    }
+}
+
+// Vector pass: head-frame yaw/pitch deltas between consecutive quaternions
+static void quaternion_deltas(const float *restrict w, const float *restrict x,
+                              const float *restrict y, const float *restrict z,
+                              const MotionState *state, size_t n,
+                              float *restrict yaw, float *restrict pitch)
+{
+    quaternion_delta(state->last_quat_w, state->last_quat_x, state->last_quat_y, state->last_quat_z,
+                     w[0], x[0], y[0], z[0], &yaw[0], &pitch[0]);
+    for (size_t i = 1; i < n; i++) {
+        quaternion_delta(w[i - 1], x[i - 1], y[i - 1], z[i - 1],
+                         w[i], x[i], y[i], z[i], &yaw[i], &pitch[i]);
+    }
+}
+
+// Sequential pass: the pose stage carries state from sample to sample
+static void pose_deltas(MotionState *state, const MotionParams *params, const uint32_t *ts,
+                        const uint64_t *time_ns, size_t n, float *yaw, float *pitch)
+{
+    for (size_t i = 0; i < n; i++) {
+        float dt = sample_interval(state, ts ? ts[i] : state->last_ts,
+                                   time_ns ? time_ns[i] : 0, params->interval);
+        pose_stage(state, params, dt, &yaw[i], &pitch[i]);
+    }
+}
+
+// Vector pass: deadzone and signed gain
+static void shape_axis(float *restrict delta, size_t n, float deadzone, float gain)
+{
+    for (size_t i = 0; i < n; i++) {
+        delta[i] = apply_deadzone(delta[i], deadzone) * gain;
+    }
+}
+
+// Sample i of a batch
+static void batch_sample(const MotionBatch *batch, size_t i, MotionSample *sample)
+{
+    bool have_quaternion = batch->quat_w != NULL;
+    MotionSample value = {
+        .roll = batch->roll[i],
+        .pitch = batch->pitch[i],
+        .yaw = batch->yaw[i],
+        .quat_w = have_quaternion ? batch->quat_w[i] : 1.0f,
+        .quat_x = have_quaternion ? batch->quat_x[i] : 0.0f,
+        .quat_y = have_quaternion ? batch->quat_y[i] : 0.0f,
+        .quat_z = have_quaternion ? batch->quat_z[i] : 0.0f,
+        .have_quaternion = have_quaternion,
+        .ts = batch->ts ? batch->ts[i] : 0,
+        .time_ns = batch->time_ns ? batch->time_ns[i] : 0,
+    };
+    *sample = value;
+}
+
+// Absolute mode reports at most one position per frame, so the batch API
+// just runs the scalar path
+static size_t process_batch_absolute(MotionState *state, const MouseConfig *config,
+                                     const MotionBatch *batch, MotionBatchOutput *out)
+{
+    size_t active = 0;
+    for (size_t i = 0; i < batch->count; i++) {
+        MotionSample sample;
+        MotionOutput result;
+        batch_sample(batch, i, &sample);
+        active += motion_process(state, config, &sample, &result);
+
+        out->move_x[i] = result.move_x;
+        out->move_y[i] = result.move_y;
+        out->scroll[i] = result.scroll;
+        if (out->scroll_hires) {
+            out->scroll_hires[i] = result.scroll_hires;
+        }
+        if (out->abs_x && out->abs_y) {
+            out->abs_x[i] = result.absolute ? result.abs_x : -1;
+            out->abs_y[i] = result.absolute ? result.abs_y : -1;
+        }
+    }
+    return active;
+}
+
+size_t motion_process_batch(MotionState *state, const MouseConfig *config,
+                            const MotionBatch *batch, MotionBatchOutput *out)
+{
+    float dx[MOTION_BATCH_CHUNK];
+    float dy[MOTION_BATCH_CHUNK];
+    float scroll_part[MOTION_BATCH_CHUNK];
+    MotionParams params = motion_params(config);
+    bool have_quaternion = batch->quat_w != NULL;
+    bool use_quaternion = params.use_quaternion && have_quaternion;
+    size_t active = 0;
+    size_t start = 0;
+
+    if (batch->count == 0) return 0;
+    if (params.absolute) {
+        return process_batch_absolute(state, config, batch, out);
+    }
+
+    // Relative mode never reports absolute positions
+    if (out->abs_x && out->abs_y) {
+        for (size_t i = 0; i < batch->count; i++) {
+            out->abs_x[i] = out->abs_y[i] = -1;
+        }
+    }
+
+    if (!state->initialized) {
+        MotionSample first;
+        batch_sample(batch, 0, &first);
+        init_reference(state, &first);
+        out->move_x[0] = out->move_y[0] = out->scroll[0] = 0;
+        if (out->scroll_hires) {
+            out->scroll_hires[0] = 0;
+        }
+        start = 1;
+    }
+
+    for (size_t base = start; base < batch->count; base += MOTION_BATCH_CHUNK) {
+        size_t n = batch->count - base;
+        if (n > MOTION_BATCH_CHUNK) n = MOTION_BATCH_CHUNK;
+        size_t last = base + n - 1;
+
+        const float *restrict roll = batch->roll + base;
+        int *restrict move_x = out->move_x + base;
+        int *restrict move_y = out->move_y + base;
+        int *restrict scroll = out->scroll + base;
+
+        if (use_quaternion) {
+            quaternion_deltas(batch->quat_w + base, batch->quat_x + base,
+                              batch->quat_y + base, batch->quat_z + base,
+                              state, n, dx, dy);
+        } else {
+            angle_deltas(batch->yaw + base, state->last_yaw, n, true, dx);
+            angle_deltas(batch->pitch + base, state->last_pitch, n, false, dy);
+        }
+        if (pose_stage_active(&params)) {
+            pose_deltas(state, &params, batch->ts ? batch->ts + base : NULL,
+                        batch->time_ns ? batch->time_ns + base : NULL, n, dx, dy);
+        } else {
+            if (batch->ts) state->last_ts = batch->ts[last];
+            state->last_time_ns = batch->time_ns ? batch->time_ns[last] : 0;
+        }
+        shape_axis(dx, n, params.deadzone, params.gain_x);
+        shape_axis(dy, n, params.deadzone, params.gain_y);
+
+        for (size_t i = 0; i < n; i++) {
+            scroll_part[i] = scroll_amount(roll[i], &params);
+        }
+
+        // Smoothing and sub-pixel accumulation carry state sample to sample
+        for (size_t i = 0; i < n; i++) {
+            accumulate(state, true, params.smoothing, dx[i], dy[i], &move_x[i], &move_y[i]);
+            int units = scroll_units(state, &params, roll[i], scroll_part[i], &scroll[i]);
+            if (out->scroll_hires) {
+                out->scroll_hires[base + i] = units;
+            }
+            active += (move_x[i] != 0 || move_y[i] != 0 || units != 0);
+        }
+
+        state->last_yaw = batch->yaw[last];
+        state->last_pitch = batch->pitch[last];
+        state->last_roll = batch->roll[last];
+        if (have_quaternion) {
+            state->last_quat_w = batch->quat_w[last];
+            state->last_quat_x = batch->quat_x[last];
+            state->last_quat_y = batch->quat_y[last];
+            state->last_quat_z = batch->quat_z[last];
+        }
+    }
+
+    return active;
+}
@@ -0,0 +1,219 @@
+#ifndef MOTION_PIPELINE_H
+#define MOTION_PIPELINE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "mouse_config.h"
+
+// Layout of an IMU packet from the Viture SDK (big-endian floats)
+#define IMU_OFFSET_ROLL     0
+#define IMU_OFFSET_PITCH    4
+#define IMU_OFFSET_YAW      8
+#define IMU_OFFSET_QUAT     20      // W, X, Y, Z
+#define IMU_QUAT_MIN_LEN    36      // Packets shorter than this carry no quaternion
+
+// Samples processed per vector pass in motion_process_batch
+#define MOTION_BATCH_CHUNK  256
+
+// Sample interval assumed when the config doesn't state an IMU rate (120 Hz)
+#define MOTION_NOMINAL_INTERVAL 0.008333f
+
+// Gaps longer than this (seconds) restart the velocity estimate
+#define MOTION_MAX_INTERVAL 0.1f
+
+// High-resolution wheel units per click, as in REL_WHEEL_HI_RES
+#define MOTION_SCROLL_HIRES 120
+
+// Absolute positions span 0..MOTION_ABS_MAX on both axes, whatever the screen size
+#define MOTION_ABS_MAX      65535
+
+// Degrees of rotation per unit of quaternion vector part (2 * 180 / pi).
+// A unit quaternion's vector part is sin(angle / 2) * axis, so for the small
+// per-frame rotations this is accurate to well under 0.1% without any trig.
+#define QUAT_TO_DEGREES     114.59155902616465f
+
+// One decoded IMU sample
+typedef struct MotionSample {
+    float roll;
+    float pitch;
+    float yaw;
+    float quat_w;
+    float quat_x;
+    float quat_y;
+    float quat_z;
+    bool have_quaternion;
+    uint32_t ts;                // SDK timestamp
+    uint64_t arrival_ns;        // CLOCK_MONOTONIC when the callback received it
+    uint64_t time_ns;           // Pose stage clock: arrival_ns live, the recorded one in a replay (0 = use ts)
+} MotionSample;
+
+// Tracking state
+typedef struct {
+    float last_yaw;
+    float last_pitch;
+    float last_roll;
+    float last_dx;
+    float last_dy;
+    bool initialized;
+
+    // Previous orientation quaternion, for the quaternion pipeline
+    float last_quat_w;
+    float last_quat_x;
+    float last_quat_y;
+    float last_quat_z;
+
+    // Pose stage: unwrapped head pose integrated from deltas, the One Euro
+    // filter and alpha-beta prediction state, and the pose last turned into
+    // movement
+    uint32_t last_ts;
+    uint64_t last_time_ns;
+    float pose_yaw;
+    float pose_pitch;
+    float euro_yaw;
+    float euro_pitch;
+    float euro_speed_yaw;       // Filtered degrees per second
+    float euro_speed_pitch;
+    float est_yaw;
+    float est_pitch;
+    float vel_yaw;              // Degrees per second
+    float vel_pitch;
+    float output_yaw;
+    float output_pitch;
+
+    // Sub-pixel precision accumulators
+    float accum_x;              // Accumulator for sub-pixel X movement
+    float accum_y;              // Accumulator for sub-pixel Y movement
+    float accum_scroll;         // Fraction of a high-resolution scroll unit
+    int scroll_detent;          // High-resolution units toward the next whole click
+    bool scrolling;             // Roll is past the threshold, or not yet back past the hysteresis
+
+    // Absolute positioning vars. The pose stage integrates movement from the
+    // center orientation, so its output is the offset from center_yaw/pitch.
+    float center_yaw;           // Center yaw value for absolute positioning
+    float center_pitch;         // Center pitch value for absolute positioning
+    int last_abs_x;             // Last absolute position reported, -1 = none
+    int last_abs_y;
+} MotionState;
+
+// Events produced by one sample
+typedef struct {
+    int move_x;                 // Whole pixels of horizontal movement
+    int move_y;                 // Whole pixels of vertical movement
+    int scroll;                 // Wheel clicks, positive scrolls up
+    int scroll_hires;           // The same scroll in 1/MOTION_SCROLL_HIRES clicks, without waiting for a whole one
+    bool absolute;              // Absolute mode produced a new position
+    int abs_x;                  // 0..MOTION_ABS_MAX, left to right
+    int abs_y;                  // 0..MOTION_ABS_MAX, top to bottom
+} MotionOutput;
+
+// Structure-of-arrays sample buffer for the batch API
+typedef struct {
+    float *roll;
+    float *pitch;
+    float *yaw;
+    float *quat_w;              // Quaternion arrays are optional (NULL when absent)
+    float *quat_x;
+    float *quat_y;
+    float *quat_z;
+    uint32_t *ts;               // Optional, used by the pose stage (NULL assumes the configured rate)
+    uint64_t *time_ns;          // Optional sample times, preferred over ts when present
+    size_t count;
+} MotionBatch;
+
+// Structure-of-arrays output buffer for the batch API
+typedef struct {
+    int *move_x;
+    int *move_y;
+    int *scroll;
+    int *scroll_hires;          // Optional
+    int *abs_x;                 // Absolute mode positions, -1 when unchanged (optional, both or neither)
+    int *abs_y;
+} MotionBatchOutput;
+
+// Pipeline parameters derived from a MouseConfig. The config states rates and
+// time constants; these are their per-sample equivalents at the configured IMU
+// rate, so the cursor feels the same at any rate.
+typedef struct {
+    float interval;             // Seconds per sample at the configured rate
+    bool use_quaternion;
+    float deadzone;             // Degrees per sample
+    float smoothing;            // Per-sample exponential smoothing factor
+    float gain_x;               // Pixels per degree, negative when inverted
+    float gain_y;
+    float scroll_threshold;     // Degrees of roll before scrolling starts
+    float scroll_release;       // Degrees of roll below which it stops again
+    float scroll_gain;          // Clicks per sample at one degree past the threshold, negative when inverted
+    float scroll_curve;         // Exponent on the degrees past the threshold
+    float scroll_max;           // Most clicks per sample, 0 = no limit
+    bool one_euro;              // Adaptive low-pass on the pose
+    float min_cutoff;           // Hz, at rest
+    float beta;                 // Extra Hz per degree/second of head speed
+    float horizon;              // Seconds of prediction, 0 = off
+    bool absolute;              // Map the pose to a screen position
+    float abs_scale_x;          // Signed screen fractions per degree from center
+    float abs_scale_y;
+} MotionParams;
+
+// Optional pipeline stages. Preparing a config picks a routine compiled for
+// exactly the stages it needs, so disabled stages cost nothing per sample.
+#define MOTION_STAGE_QUATERNION (1u << 0)   // Deltas from the quaternion
+#define MOTION_STAGE_POSE       (1u << 1)   // One Euro filter, prediction or absolute mapping
+#define MOTION_STAGE_ABSOLUTE   (1u << 2)   // Screen positions instead of movement
+#define MOTION_STAGE_DEADZONE   (1u << 3)
+#define MOTION_STAGE_SMOOTHING  (1u << 4)
+#define MOTION_VARIANTS         32
+
+struct MotionConfig;
+typedef bool (*MotionProcessFn)(MotionState *state, const struct MotionConfig *prepared,
+                                const MotionSample *sample, MotionOutput *out);
+
+// A config together with its derived parameters and specialized routine,
+// prepared once when the config changes instead of on every sample
+typedef struct MotionConfig {
+    MouseConfig config;
+    MotionParams params;
+    unsigned int stages;        // MOTION_STAGE_* bits in use
+    MotionProcessFn process;
+} MotionConfig;
+
+void motion_config_prepare(MotionConfig *prepared, const MouseConfig *config);
+
+// Forget the reference orientation; the next sample re-initializes it
+void motion_state_reset(MotionState *state);
+
+// Decode a raw SDK packet into a sample
+void motion_decode(const uint8_t *data, uint16_t len, uint32_t ts, MotionSample *sample);
+
+// Run one sample through the pipeline. Pure: touches only state and out.
+// Returns true if the sample produced any movement or scroll.
+bool motion_process(MotionState *state, const MouseConfig *config,
+                    const MotionSample *sample, MotionOutput *out);
+
+// motion_process with the config already prepared
+bool motion_process_prepared(MotionState *state, const MotionConfig *prepared,
+                             const MotionSample *sample, MotionOutput *out);
+
+// The same pipeline with every stage check done at run time, for benchmarks
+// and for checking the specialized routines against
+bool motion_process_generic(MotionState *state, const MotionConfig *prepared,
+                            const MotionSample *sample, MotionOutput *out);
+
+// The routine specialized for a set of MOTION_STAGE_* bits, whatever config
+// it is used with (tests)
+MotionProcessFn motion_process_variant(unsigned int stages);
+
+// Decode count packets laid out stride bytes apart into batch->roll/pitch/yaw,
+// and the quaternion arrays if present and the packets are long enough.
+// ts and time_ns are left to the caller since they arrive out of band.
+void motion_decode_batch(const uint8_t *packets, size_t stride, size_t count,
+                         MotionBatch *batch);
+
+// Run a whole batch through the pipeline. Produces exactly the same output as
+// calling motion_process on each sample in turn. Returns the number of samples
+// that produced movement or scroll.
+size_t motion_process_batch(MotionState *state, const MouseConfig *config,
+                            const MotionBatch *batch, MotionBatchOutput *out);
+
+#endif // MOTION_PIPELINE_H
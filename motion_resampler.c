@@ -0,0 +1,104 @@
+#include <string.h>
+
+#include "motion_resampler.h"
+
+#define HISTORY_MASK (RESAMPLER_HISTORY - 1)
+
+void motion_resampler_reset(MotionResampler *resampler)
+{
+    memset(resampler, 0, sizeof(*resampler));
+}
+
+void motion_resampler_add(MotionResampler *resampler, uint64_t time_ns, const MotionOutput *out)
+{
+    resampler->total_x += out->move_x;
+    resampler->total_y += out->move_y;
+    resampler->pending_scroll += out->scroll;
+    resampler->pending_scroll_hires += out->scroll_hires;
+    if (out->absolute) {
+        resampler->pending_absolute = true;
+        resampler->abs_x = out->abs_x;
+        resampler->abs_y = out->abs_y;
+    }
+
+    ResamplePoint *point = &resampler->points[resampler->count & HISTORY_MASK];
+    point->time_ns = time_ns;
+    point->x = resampler->total_x;
+    point->y = resampler->total_y;
+    resampler->count++;
+}
+
+// Position on the path at time_ns
+static void path_position(const MotionResampler *resampler, uint64_t time_ns,
+                          int64_t *x, int64_t *y)
+{
+    unsigned int available = resampler->count < RESAMPLER_HISTORY ? resampler->count : RESAMPLER_HISTORY;
+    unsigned int newest = resampler->count - 1;
+    const ResamplePoint *after = NULL;
+
+    // Walk back from the newest point to the one at or before time_ns
+    for (unsigned int i = 0; i < available; i++) {
+        const ResamplePoint *point = &resampler->points[(newest - i) & HISTORY_MASK];
+        if (point->time_ns <= time_ns) {
+            if (!after || after->time_ns == point->time_ns) {
+                *x = (after ? after : point)->x;
+                *y = (after ? after : point)->y;
+            } else {
+                double fraction = (double)(time_ns - point->time_ns) /
+                                  (double)(after->time_ns - point->time_ns);
+                *x = point->x + (int64_t)((after->x - point->x) * fraction);
+                *y = point->y + (int64_t)((after->y - point->y) * fraction);
+            }
+            return;
+        }
+        after = point;
+    }
+
+    // Older than anything remembered: hold at the oldest point
+    *x = after->x;
+    *y = after->y;
+}
+
+// Hand out the scroll and absolute position collected since the last tick
+static void take_pending(MotionResampler *resampler, MotionOutput *out)
+{
+    out->scroll = resampler->pending_scroll;
+    out->scroll_hires = resampler->pending_scroll_hires;
+    out->absolute = resampler->pending_absolute;
+    out->abs_x = resampler->abs_x;
+    out->abs_y = resampler->abs_y;
+    resampler->pending_scroll = 0;
+    resampler->pending_scroll_hires = 0;
+    resampler->pending_absolute = false;
+}
+
+bool motion_resampler_tick(MotionResampler *resampler, uint64_t now_ns, uint64_t delay_ns,
+                           MotionOutput *out)
+{
+    int64_t x = resampler->emitted_x;
+    int64_t y = resampler->emitted_y;
+
+    if (resampler->count > 0) {
+        uint64_t render_ns = now_ns > delay_ns ? now_ns - delay_ns : 0;
+        path_position(resampler, render_ns, &x, &y);
+    }
+
+    out->move_x = (int)(x - resampler->emitted_x);
+    out->move_y = (int)(y - resampler->emitted_y);
+    resampler->emitted_x = x;
+    resampler->emitted_y = y;
+    take_pending(resampler, out);
+
+    return out->move_x != 0 || out->move_y != 0 || out->scroll_hires != 0 || out->absolute;
+}
+
+bool motion_resampler_flush(MotionResampler *resampler, MotionOutput *out)
+{
+    out->move_x = (int)(resampler->total_x - resampler->emitted_x);
+    out->move_y = (int)(resampler->total_y - resampler->emitted_y);
+    resampler->emitted_x = resampler->total_x;
+    resampler->emitted_y = resampler->total_y;
+    take_pending(resampler, out);
+
+    return out->move_x != 0 || out->move_y != 0 || out->scroll_hires != 0 || out->absolute;
+}
@@ -0,0 +1,53 @@
+#ifndef MOTION_RESAMPLER_H
+#define MOTION_RESAMPLER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "motion_pipeline.h"
+
+// Pipeline outputs remembered for interpolation (power of two)
+#define RESAMPLER_HISTORY 8
+
+// One point on the cursor's path: total movement so far at a sample's arrival
+typedef struct {
+    uint64_t time_ns;
+    int64_t x;
+    int64_t y;
+} ResamplePoint;
+
+// Turns pipeline output that arrives at the IMU's (jittery) rate into one
+// movement per output tick. The cursor path is the running total of the
+// pipeline's movement, timestamped by sample arrival; each tick samples that
+// path a fixed delay in the past, interpolating between the two samples
+// around it. Ticks that outrun the newest sample hold there rather than
+// extrapolate, so every pixel the pipeline produced is emitted exactly once
+// and the cursor never overshoots.
+typedef struct {
+    ResamplePoint points[RESAMPLER_HISTORY];
+    unsigned int count;         // Points added so far
+    int64_t total_x;            // Running totals of pipeline output
+    int64_t total_y;
+    int64_t emitted_x;          // Movement already handed out by ticks
+    int64_t emitted_y;
+    int pending_scroll;         // Scroll isn't resampled, it goes out on the next tick
+    int pending_scroll_hires;
+    bool pending_absolute;      // Absolute positions aren't either, the newest goes out
+    int abs_x;
+    int abs_y;
+} MotionResampler;
+
+void motion_resampler_reset(MotionResampler *resampler);
+
+// Add one sample's pipeline output, arrival times must not go backwards
+void motion_resampler_add(MotionResampler *resampler, uint64_t time_ns, const MotionOutput *out);
+
+// Movement for a tick at now_ns, following the path delay_ns behind.
+// Returns true if there is anything to emit.
+bool motion_resampler_tick(MotionResampler *resampler, uint64_t now_ns, uint64_t delay_ns,
+                           MotionOutput *out);
+
+// Everything not yet emitted, for shutdown or leaving resampled mode
+bool motion_resampler_flush(MotionResampler *resampler, MotionOutput *out);
+
+#endif // MOTION_RESAMPLER_H
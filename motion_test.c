@@ -0,0 +1,671 @@
+// Consistency checks for the motion pipeline (ctest, or run directly). Every
+// synthetic signal in imu_synth.h is run through a set of configs, and each
+// way of processing it must give exactly the same output as
+// motion_process_generic:
+//   - motion_process, which picks the routine specialized for the config
+//   - every one of the MOTION_VARIANTS specialized routines, each against
+//     the generic pipeline running the same stages
+//   - motion_process_batch, against motion_process sample by sample
+// Each signal runs with SDK timestamps only, then again with sample times.
+// A capture replayed at different speeds must give the same output.
+// Scrolling is also stepped through its start, hold and release transitions.
+//
+// Since a sign or scale error shared by every routine would pass all of
+// that, the pipeline is also held to values worked out by hand: head turns
+// of known size must move the cursor the expected number of pixels.
+//
+// Usage: motion_test [SAMPLES]
+// Prints each mismatch and a summary line; exits non-zero on any mismatch.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "motion_pipeline.h"
+#include "imu_synth.h"
+#include "imu_capture.h"
+
+#define DEFAULT_SAMPLES 6000
+#define RATE 120
+#define NOMINAL_NS (1000000000ull / RATE)
+
+// Mismatches printed per check before the rest are only counted
+#define MAX_REPORTS 5
+
+typedef struct {
+    const char *name;
+    MouseConfig config;
+} TestConfig;
+
+// One signal's samples, decoded per sample and into batch columns
+typedef struct {
+    uint8_t *packets;
+    uint32_t *ts;
+    uint64_t *time_ns;
+    MotionSample *samples;
+    MotionBatch batch;
+    size_t count;
+} TestData;
+
+static unsigned long checks;
+static unsigned long failures;
+
+static bool same_output(const MotionOutput *a, const MotionOutput *b) {
+    return a->move_x == b->move_x && a->move_y == b->move_y &&
+           a->scroll == b->scroll && a->scroll_hires == b->scroll_hires &&
+           a->absolute == b->absolute && a->abs_x == b->abs_x && a->abs_y == b->abs_y;
+}
+
+static void report(const char *check, const char *signal, const char *config, unsigned int stages,
+                   size_t index, const MotionOutput *want, const MotionOutput *got, int *reports) {
+    failures++;
+    if ((*reports)++ >= MAX_REPORTS) return;
+    printf("FAIL check=%s signal=%s config=%s stages=0x%02x sample=%zu"
+           " want=(%d,%d scroll=%d/%d abs=%d %d,%d) got=(%d,%d scroll=%d/%d abs=%d %d,%d)\n",
+           check, signal, config, stages, index,
+           want->move_x, want->move_y, want->scroll, want->scroll_hires,
+           want->absolute, want->abs_x, want->abs_y,
+           got->move_x, got->move_y, got->scroll, got->scroll_hires,
+           got->absolute, got->abs_x, got->abs_y);
+}
+
+// Run the signal through two routines with their own state, sample by sample
+static void compare_routines(const char *check, const char *signal, const char *config,
+                             MotionProcessFn want_fn, const MotionConfig *want_config,
+                             MotionProcessFn got_fn, const MotionConfig *got_config,
+                             const TestData *data) {
+    MotionState want_state, got_state;
+    motion_state_reset(&want_state);
+    motion_state_reset(&got_state);
+    int reports = 0;
+
+    for (size_t i = 0; i < data->count; i++) {
+        MotionOutput want, got;
+        memset(&want, 0, sizeof(want));
+        memset(&got, 0, sizeof(got));
+        bool want_active = want_fn(&want_state, want_config, &data->samples[i], &want);
+        bool got_active = got_fn(&got_state, got_config, &data->samples[i], &got);
+
+        checks++;
+        if (want_active != got_active || !same_output(&want, &got)) {
+            report(check, signal, config, got_config->stages, i, &want, &got, &reports);
+        }
+    }
+}
+
+// motion_process through a prepared config, to fit compare_routines
+static bool process_scalar(MotionState *state, const MotionConfig *prepared,
+                           const MotionSample *sample, MotionOutput *out) {
+    return motion_process(state, &prepared->config, sample, out);
+}
+
+// The batch API against motion_process on each sample in turn
+static void compare_batch(const char *signal, const TestConfig *test, const TestData *data,
+                          MotionBatchOutput *out) {
+    MotionState batch_state, scalar_state;
+    motion_state_reset(&batch_state);
+    motion_state_reset(&scalar_state);
+    int reports = 0;
+
+    size_t batch_active = motion_process_batch(&batch_state, &test->config, &data->batch, out);
+    size_t scalar_active = 0;
+    for (size_t i = 0; i < data->count; i++) {
+        MotionOutput want;
+        memset(&want, 0, sizeof(want));
+        scalar_active += motion_process(&scalar_state, &test->config, &data->samples[i], &want);
+
+        // The batch reports positions only, -1 when unchanged
+        MotionOutput got = {
+            .move_x = out->move_x[i], .move_y = out->move_y[i],
+            .scroll = out->scroll[i], .scroll_hires = out->scroll_hires[i],
+            .absolute = out->abs_x[i] >= 0,
+            .abs_x = out->abs_x[i] >= 0 ? out->abs_x[i] : want.abs_x,
+            .abs_y = out->abs_y[i] >= 0 ? out->abs_y[i] : want.abs_y,
+        };
+        if (!want.absolute) {
+            want.abs_x = got.abs_x;
+            want.abs_y = got.abs_y;
+        }
+
+        checks++;
+        if (!same_output(&want, &got)) {
+            report("batch", signal, test->name, 0, i, &want, &got, &reports);
+        }
+    }
+
+    checks++;
+    if (batch_active != scalar_active) {
+        failures++;
+        printf("FAIL check=batch_active signal=%s config=%s want=%zu got=%zu\n",
+               signal, test->name, scalar_active, batch_active);
+    }
+}
+
+static void test_config(const char *signal, const TestConfig *test, const TestData *data,
+                        MotionBatchOutput *out) {
+    MotionConfig prepared;
+    motion_config_prepare(&prepared, &test->config);
+
+    compare_routines("scalar", signal, test->name, motion_process_generic, &prepared,
+                     process_scalar, &prepared, data);
+
+    // Every specialized routine against the generic one with the same stages,
+    // including stages the config itself would leave out
+    for (unsigned int stages = 0; stages < MOTION_VARIANTS; stages++) {
+        MotionConfig forced = prepared;
+        forced.stages = stages;
+        compare_routines("variant", signal, test->name, motion_process_generic, &forced,
+                         motion_process_variant(stages), &forced, data);
+    }
+
+    compare_batch(signal, test, data, out);
+}
+
+// Replay target: each record goes through the pipeline as in the daemon,
+// with the pose stage timed by the recorded arrival time
+static MotionState replay_state;
+static MotionConfig replay_config;
+static MotionOutput *replay_out;
+static size_t replay_count;
+
+static void replay_sample(uint8_t *data, uint16_t len, uint32_t ts, uint64_t time_ns) {
+    MotionSample sample;
+    motion_decode(data, len, ts, &sample);
+    sample.time_ns = time_ns;
+    memset(&replay_out[replay_count], 0, sizeof(MotionOutput));
+    motion_process_prepared(&replay_state, &replay_config, &sample, &replay_out[replay_count++]);
+}
+
+// Write packets as a capture, record i arriving at times[i]
+static bool write_capture(const char *path, const uint8_t *packets, const uint32_t *ts,
+                          const uint64_t *times, size_t count) {
+    static const uint8_t padding[8];
+    size_t payload = IMU_SYNTH_PACKET_SIZE;
+    size_t record_size = (sizeof(ImuCaptureRecord) + payload + 7) & ~(size_t)7;
+    ImuCaptureHeader header = {
+        .magic = IMU_CAPTURE_MAGIC, .version = IMU_CAPTURE_VERSION,
+        .header_size = sizeof(ImuCaptureHeader),
+        .data_size = count * record_size, .record_count = count,
+    };
+    FILE *file = fopen(path, "wb");
+    if (!file) {
+        perror("Failed to create test capture");
+        return false;
+    }
+    bool ok = fwrite(&header, sizeof(header), 1, file) == 1;
+    for (size_t i = 0; ok && i < count; i++) {
+        ImuCaptureRecord record = { .time_ns = times[i], .ts = ts[i], .len = payload };
+        ok = fwrite(&record, sizeof(record), 1, file) == 1 &&
+             fwrite(packets + i * payload, payload, 1, file) == 1 &&
+             fwrite(padding, record_size - sizeof(record) - payload, 1, file) <= 1;
+    }
+    return fclose(file) == 0 && ok;
+}
+
+// A replay reproduces its capture whatever the pace: as fast as possible and
+// at 8x must move the cursor exactly alike, with the filter and prediction
+// (which both follow sample timing) on
+static void test_replay_pace(const MouseConfig *base, const TestData *data) {
+    MouseConfig config = *base;
+    config.filter = FILTER_ONE_EURO;
+    config.prediction_ms = 20.0f;
+    motion_config_prepare(&replay_config, &config);
+
+    size_t count = data->count < 2 * RATE ? data->count : 2 * RATE;
+    char path[] = "/tmp/motion_test_XXXXXX";
+    int fd = mkstemp(path);
+    MotionOutput *outputs = malloc(2 * count * sizeof(MotionOutput));
+    checks++;
+    if (fd < 0 || !outputs || !write_capture(path, data->packets, data->ts, data->time_ns, count)) {
+        failures++;
+        printf("FAIL check=replay_pace could not write a test capture\n");
+        if (fd >= 0) {
+            close(fd);
+            unlink(path);
+        }
+        free(outputs);
+        return;
+    }
+    close(fd);
+
+    const double speeds[2] = { 0.0, 8.0 };
+    for (int run = 0; run < 2; run++) {
+        motion_state_reset(&replay_state);
+        replay_out = outputs + run * count;
+        replay_count = 0;
+        if (imu_replay(path, speeds[run], replay_sample) != (long)count) {
+            failures++;
+            printf("FAIL check=replay_pace speed=%.0f replayed %zu of %zu records\n",
+                   speeds[run], replay_count, count);
+        }
+    }
+    unlink(path);
+
+    int reports = 0;
+    for (size_t i = 0; i < count; i++) {
+        checks++;
+        if (!same_output(&outputs[i], &outputs[count + i])) {
+            report("replay_pace", "fast_flick", "one_euro_predict", replay_config.stages, i,
+                   &outputs[i], &outputs[count + i], &reports);
+        }
+    }
+    free(outputs);
+}
+
+// Hold the head at roll degrees for one sample; returns the scroll units
+static int roll_step(MotionState *state, const MotionConfig *prepared, float roll, uint32_t *ts) {
+    MotionSample sample = { .roll = roll, .quat_w = 1.0f, .ts = (*ts)++ * 1000 / RATE };
+    MotionOutput out;
+    motion_process_prepared(state, prepared, &sample, &out);
+    return out.scroll_hires;
+}
+
+static void expect_scroll(const char *step, const MotionState *state, int units,
+                          bool scrolling, bool moving) {
+    checks++;
+    if (state->scrolling != scrolling || (units != 0) != moving) {
+        failures++;
+        printf("FAIL check=scroll step=%s scrolling=%d units=%d, expected scrolling=%d %s\n",
+               step, state->scrolling, units, scrolling, moving ? "units" : "no units");
+    }
+}
+
+// Scrolling starts past the threshold, keeps its remainder inside it down to
+// the release angle, and only stops below that
+static void test_scroll_transitions(const MouseConfig *base) {
+    MouseConfig config = *base;
+    config.roll_scroll_threshold = 10.0f;
+    config.scroll_hysteresis = 3.0f;
+    MotionConfig prepared;
+    motion_config_prepare(&prepared, &config);
+
+    for (int sign = -1; sign <= 1; sign += 2) {
+        MotionState state;
+        motion_state_reset(&state);
+        uint32_t ts = 0;
+        roll_step(&state, &prepared, 0.0f, &ts);
+
+        expect_scroll("below", &state, roll_step(&state, &prepared, sign * 9.5f, &ts), false, false);
+        expect_scroll("start", &state, roll_step(&state, &prepared, sign * 12.0f, &ts), true, true);
+        expect_scroll("hold", &state, roll_step(&state, &prepared, sign * 8.0f, &ts), true, false);
+        checks++;
+        if (state.accum_scroll == 0.0f && state.scroll_detent == 0) {
+            failures++;
+            printf("FAIL check=scroll step=hold remainder lost inside the hysteresis\n");
+        }
+        expect_scroll("release", &state, roll_step(&state, &prepared, sign * 6.5f, &ts), false, false);
+        checks++;
+        if (state.accum_scroll != 0.0f || state.scroll_detent != 0) {
+            failures++;
+            printf("FAIL check=scroll step=release remainder kept after release\n");
+        }
+        expect_scroll("no_restart", &state, roll_step(&state, &prepared, sign * 8.0f, &ts), false, false);
+        expect_scroll("restart", &state, roll_step(&state, &prepared, sign * 10.5f, &ts), true, true);
+    }
+
+    // A threshold lowered past the hysteresis still releases, at half of it
+    config.roll_scroll_threshold = 2.5f;
+    motion_config_prepare(&prepared, &config);
+    MotionState state;
+    motion_state_reset(&state);
+    uint32_t ts = 0;
+    roll_step(&state, &prepared, 0.0f, &ts);
+    expect_scroll("low_start", &state, roll_step(&state, &prepared, 5.0f, &ts), true, true);
+    expect_scroll("low_hold", &state, roll_step(&state, &prepared, 1.5f, &ts), true, false);
+    expect_scroll("low_release", &state, roll_step(&state, &prepared, 1.0f, &ts), false, false);
+}
+
+// A measured value against one worked out by hand
+static void expect_near(const char *check, const char *what, double got, double want,
+                        double tolerance) {
+    checks++;
+    if (fabs(got - want) > tolerance) {
+        failures++;
+        printf("FAIL check=%s %s=%.2f, expected %.2f +- %.2f\n", check, what, got, want, tolerance);
+    }
+}
+
+// Run the head at one orientation (degrees) through the pipeline as an SDK
+// packet, sample *index at RATE
+static void pose_step(MotionState *state, const MotionConfig *prepared, float roll, float pitch,
+                      float yaw, uint32_t *index, MotionOutput *out) {
+    uint8_t packet[IMU_SYNTH_PACKET_SIZE];
+    MotionSample sample;
+    // The SDK reports yaw within +-180 degrees
+    yaw = yaw > 180.0f ? yaw - 360.0f : yaw;
+    imu_synth_encode(roll, pitch, yaw, packet);
+    motion_decode(packet, sizeof(packet), (*index)++ * 1000 / RATE, &sample);
+    motion_process_prepared(state, prepared, &sample, out);
+}
+
+// Cursor travel over a steady turn from (pitch, yaw) by (turn_pitch,
+// turn_yaw) degrees, in steps of at most a quarter degree, after one sample
+// to settle on the start
+static void turn(const MotionConfig *prepared, float roll, float pitch, float yaw,
+                 float turn_pitch, float turn_yaw, int *x, int *y) {
+    MotionState state;
+    MotionOutput out;
+    uint32_t index = 0;
+    motion_state_reset(&state);
+    pose_step(&state, prepared, roll, pitch, yaw, &index, &out);
+
+    int steps = (int)ceilf(fmaxf(fabsf(turn_pitch), fabsf(turn_yaw)) * 4.0f);
+    *x = *y = 0;
+    for (int i = 1; i <= steps; i++) {
+        pose_step(&state, prepared, roll, pitch + turn_pitch * i / steps,
+                  yaw + turn_yaw * i / steps, &index, &out);
+        *x += out.move_x;
+        *y += out.move_y;
+    }
+}
+
+// Sensitivity is pixels per degree: turning right moves the cursor right,
+// looking up moves it up (with the shipped invert_y), and invert_x flips X
+static void test_gain(const MouseConfig *base) {
+    MouseConfig config = *base;
+    MotionConfig prepared;
+    int x, y;
+
+    motion_config_prepare(&prepared, &config);
+    turn(&prepared, 0.0f, 0.0f, 0.0f, 0.0f, 10.0f, &x, &y);
+    expect_near("gain", "yaw_x", x, 10.0 * config.sensitivity_yaw, 1.0);
+    expect_near("gain", "yaw_y", y, 0.0, 0.0);
+
+    turn(&prepared, 0.0f, 0.0f, 0.0f, 10.0f, 0.0f, &x, &y);
+    expect_near("gain", "pitch_x", x, 0.0, 0.0);
+    expect_near("gain", "pitch_y", y, -10.0 * config.sensitivity_pitch, 1.0);
+
+    // Across the +-180 degree wrap the turn is still 10 degrees to the right
+    turn(&prepared, 0.0f, 0.0f, 175.0f, 0.0f, 10.0f, &x, &y);
+    expect_near("gain", "wrap_x", x, 10.0 * config.sensitivity_yaw, 1.0);
+
+    config.invert_x = true;
+    config.sensitivity_yaw = 20.0f;
+    motion_config_prepare(&prepared, &config);
+    turn(&prepared, 0.0f, 0.0f, 0.0f, 0.0f, 10.0f, &x, &y);
+    expect_near("gain", "inverted_x", x, -200.0, 1.0);
+}
+
+// The quaternion path matches the Euler one when the head isn't rolled, and
+// turning about the head's own vertical axis while rolled (the screen rolls
+// with the glasses) moves the cursor along X only
+static void test_quaternion(const MouseConfig *base) {
+    MouseConfig config = *base;
+    MotionConfig euler, quaternion;
+    int euler_x, euler_y, x, y;
+
+    config.use_quaternion = false;
+    motion_config_prepare(&euler, &config);
+    config.use_quaternion = true;
+    motion_config_prepare(&quaternion, &config);
+
+    turn(&euler, 0.0f, 0.0f, 0.0f, 0.0f, 20.0f, &euler_x, &euler_y);
+    turn(&quaternion, 0.0f, 0.0f, 0.0f, 0.0f, 20.0f, &x, &y);
+    expect_near("quaternion", "yaw_x", x, euler_x, 1.0);
+    expect_near("quaternion", "yaw_y", y, euler_y, 1.0);
+    expect_near("quaternion", "yaw_x_pixels", x, 20.0 * config.sensitivity_yaw, 1.0);
+
+    turn(&euler, 0.0f, 0.0f, 20.0f, -10.0f, 0.0f, &euler_x, &euler_y);
+    turn(&quaternion, 0.0f, 0.0f, 20.0f, -10.0f, 0.0f, &x, &y);
+    expect_near("quaternion", "pitch_x", x, euler_x, 1.0);
+    expect_near("quaternion", "pitch_y", y, euler_y, 1.0);
+    expect_near("quaternion", "pitch_y_pixels", y, 10.0 * config.sensitivity_pitch, 1.0);
+
+    // Orientation roll(30) * yaw(t): rolled first, then turned 10 degrees
+    // about the rolled head's Z axis, fed as the Euler angles that encode it
+    MotionState state;
+    MotionOutput out;
+    uint32_t index = 0;
+    double half_roll = 15.0 * M_PI / 180.0;
+    motion_state_reset(&state);
+    x = y = 0;
+    for (int i = 0; i <= 40; i++) {
+        double half_yaw = i * 0.25 * 0.5 * M_PI / 180.0;
+        double w = cos(half_roll) * cos(half_yaw), qx = sin(half_roll) * cos(half_yaw);
+        double qy = -sin(half_roll) * sin(half_yaw), qz = cos(half_roll) * sin(half_yaw);
+        double roll = atan2(2.0 * (w * qx + qy * qz), 1.0 - 2.0 * (qx * qx + qy * qy));
+        double pitch = asin(2.0 * (w * qy - qz * qx));
+        double yaw = atan2(2.0 * (w * qz + qx * qy), 1.0 - 2.0 * (qy * qy + qz * qz));
+        pose_step(&state, &quaternion, roll * 180.0 / M_PI, pitch * 180.0 / M_PI,
+                  yaw * 180.0 / M_PI, &index, &out);
+        x += out.move_x;
+        y += out.move_y;
+    }
+    expect_near("quaternion", "rolled_x", x, 10.0 * config.sensitivity_yaw, 1.0);
+    expect_near("quaternion", "rolled_y", y, 0.0, 1.0);
+}
+
+// On a steady turn prediction runs ahead of the head by prediction_ms. A 60
+// degree turn over 2 s (30 degrees/second) gives the estimate time to settle.
+static void test_prediction(const MouseConfig *base) {
+    MouseConfig config = *base;
+    MotionConfig plain, predicted;
+    int plain_x, predicted_x, y;
+
+    motion_config_prepare(&plain, &config);
+    config.prediction_ms = 50.0f;
+    motion_config_prepare(&predicted, &config);
+
+    turn(&plain, 0.0f, 0.0f, 0.0f, 0.0f, 60.0f, &plain_x, &y);
+    turn(&predicted, 0.0f, 0.0f, 0.0f, 0.0f, 60.0f, &predicted_x, &y);
+    double speed = 30.0 * config.sensitivity_yaw;     // Pixels per second
+    expect_near("prediction", "lead_ms", (predicted_x - plain_x) / speed * 1000.0,
+                config.prediction_ms, 0.05 * config.prediction_ms);
+}
+
+// Cursor path length (pixels, both axes) over a whole signal
+static long path_length(const MotionConfig *prepared, const TestData *data) {
+    MotionState state;
+    motion_state_reset(&state);
+    long length = 0;
+    for (size_t i = 0; i < data->count; i++) {
+        MotionOutput out;
+        motion_process_prepared(&state, prepared, &data->samples[i], &out);
+        length += labs(out.move_x) + labs(out.move_y);
+    }
+    return length;
+}
+
+// With the head still, the One Euro filter holds the cursor far steadier
+// than the unfiltered pipeline, which passes the sensor noise straight on
+static void test_one_euro(const MouseConfig *base, const TestData *stationary) {
+    MouseConfig config = *base;
+    MotionConfig plain, filtered;
+
+    motion_config_prepare(&plain, &config);
+    config.filter = FILTER_ONE_EURO;
+    motion_config_prepare(&filtered, &config);
+
+    long jitter = path_length(&plain, stationary);
+    long filtered_jitter = path_length(&filtered, stationary);
+    checks++;
+    if (jitter == 0 || filtered_jitter * 4 > jitter) {
+        failures++;
+        printf("FAIL check=one_euro jitter=%ld px unfiltered, %ld px filtered, expected under a quarter\n",
+               jitter, filtered_jitter);
+    }
+}
+
+// Last absolute position reported over a turn from straight ahead
+static void absolute_turn(const MotionConfig *prepared, float turn_pitch, float turn_yaw,
+                          int *abs_x, int *abs_y) {
+    MotionState state;
+    MotionOutput out;
+    uint32_t index = 0;
+    motion_state_reset(&state);
+    pose_step(&state, prepared, 0.0f, 0.0f, 0.0f, &index, &out);
+
+    *abs_x = *abs_y = -1;
+    for (int i = 1; i <= 40; i++) {
+        pose_step(&state, prepared, 0.0f, turn_pitch * i / 40, turn_yaw * i / 40, &index, &out);
+        if (out.absolute) {
+            *abs_x = out.abs_x;
+            *abs_y = out.abs_y;
+        }
+    }
+}
+
+// Absolute mode maps the head direction across yaw_range and pitch_range,
+// centered where tracking started: half the range to either side reaches
+// the screen edge
+static void test_absolute(const MouseConfig *base) {
+    MouseConfig config = *base;
+    config.absolute_mode = true;
+    MotionConfig prepared;
+    motion_config_prepare(&prepared, &config);
+    int x, y;
+
+    absolute_turn(&prepared, 0.0f, config.yaw_range / 2, &x, &y);
+    expect_near("absolute", "right_x", x, MOTION_ABS_MAX, 0.0);
+    expect_near("absolute", "right_y", y, MOTION_ABS_MAX / 2 + 1, 0.0);
+
+    absolute_turn(&prepared, 0.0f, -config.yaw_range / 2, &x, &y);
+    expect_near("absolute", "left_x", x, 0.0, 0.0);
+
+    absolute_turn(&prepared, 0.0f, config.yaw_range / 4, &x, &y);
+    expect_near("absolute", "quarter_x", x, 0.75 * MOTION_ABS_MAX, 1.0);
+
+    // Looking up reaches the top of the screen with the shipped invert_y
+    absolute_turn(&prepared, config.pitch_range / 2, 0.0f, &x, &y);
+    expect_near("absolute", "up_x", x, MOTION_ABS_MAX / 2 + 1, 0.0);
+    expect_near("absolute", "up_y", y, 0.0, 0.0);
+}
+
+int main(int argc, char *argv[]) {
+    size_t count = argc > 1 ? strtoul(argv[1], NULL, 10) : DEFAULT_SAMPLES;
+    if (count == 0) {
+        fprintf(stderr, "Usage: %s [SAMPLES]\n", argv[0]);
+        return 1;
+    }
+
+    TestData data = { .count = count };
+    data.packets = malloc(count * IMU_SYNTH_PACKET_SIZE);
+    data.ts = malloc(count * sizeof(uint32_t));
+    data.time_ns = malloc(count * sizeof(uint64_t));
+    data.samples = malloc(count * sizeof(MotionSample));
+    float *columns = malloc(7 * count * sizeof(float));
+    int *outputs = malloc(6 * count * sizeof(int));
+    if (!data.packets || !data.ts || !data.time_ns || !data.samples || !columns || !outputs) {
+        perror("Failed to allocate samples");
+        return 1;
+    }
+
+    data.batch = (MotionBatch){
+        .roll = columns, .pitch = columns + count, .yaw = columns + 2 * count,
+        .quat_w = columns + 3 * count, .quat_x = columns + 4 * count,
+        .quat_y = columns + 5 * count, .quat_z = columns + 6 * count,
+        .ts = data.ts, .count = count
+    };
+    MotionBatchOutput out = {
+        .move_x = outputs, .move_y = outputs + count, .scroll = outputs + 2 * count,
+        .abs_x = outputs + 3 * count, .abs_y = outputs + 4 * count,
+        .scroll_hires = outputs + 5 * count
+    };
+
+    // Shipped defaults: no deadzone, no smoothing, Euler angles
+    MouseConfig defaults = {
+        .sensitivity_yaw = 45.0f,
+        .sensitivity_pitch = 45.0f,
+        .imu_rate = RATE,
+        .filter = FILTER_LEGACY,
+        .euro_min_cutoff = 1.0f,
+        .euro_beta = 0.2f,
+        .roll_scroll_threshold = 10.0f,
+        .scroll_hysteresis = 3.0f,
+        .scroll_speed = 12.0f,
+        .scroll_curve = 1.0f,
+        .scroll_max_speed = 40.0f,
+        .invert_y = true,
+        .yaw_range = 60.0f,
+        .pitch_range = 40.0f,
+    };
+
+    TestConfig tests[] = {
+        { "default", defaults },
+        { "full", defaults },
+        { "one_euro", defaults },
+        { "scroll_curve", defaults },
+        { "absolute", defaults },
+        { "absolute_quaternion", defaults },
+    };
+
+    // Every relative-mode stage on
+    tests[1].config.use_quaternion = true;
+    tests[1].config.deadzone_speed = 3.0f;
+    tests[1].config.smoothing_ms = 30.0f;
+    tests[1].config.prediction_ms = 20.0f;
+    tests[1].config.invert_x = true;
+
+    tests[2].config.filter = FILTER_ONE_EURO;
+    tests[2].config.deadzone_speed = 1.0f;
+
+    tests[3].config.scroll_curve = 1.7f;
+    tests[3].config.scroll_max_speed = 0.0f;
+    tests[3].config.invert_scroll = true;
+    tests[3].config.scroll_axis = SCROLL_HORIZONTAL;
+
+    tests[4].config.absolute_mode = true;
+
+    tests[5].config.absolute_mode = true;
+    tests[5].config.use_quaternion = true;
+    tests[5].config.filter = FILTER_ONE_EURO;
+    tests[5].config.prediction_ms = 15.0f;
+
+    size_t config_count = sizeof(tests) / sizeof(tests[0]);
+    for (int signal = 0; signal < IMU_SYNTH_COUNT; signal++) {
+        const char *name = imu_synth_name((ImuSynthSignal)signal);
+        imu_synth_generate((ImuSynthSignal)signal, RATE, data.packets, IMU_SYNTH_PACKET_SIZE,
+                           data.ts, count);
+        for (size_t i = 0; i < count; i++) {
+            motion_decode(data.packets + i * IMU_SYNTH_PACKET_SIZE, IMU_SYNTH_PACKET_SIZE,
+                          data.ts[i], &data.samples[i]);
+        }
+        motion_decode_batch(data.packets, IMU_SYNTH_PACKET_SIZE, count, &data.batch);
+        data.batch.ts = data.ts;
+        data.batch.time_ns = NULL;
+        for (size_t c = 0; c < config_count; c++) {
+            test_config(name, &tests[c], &data, &out);
+        }
+        if (signal == IMU_SYNTH_STATIONARY) {
+            test_one_euro(&defaults, &data);
+        }
+
+        // Again with sample times, which take over from ts. Every third
+        // sample lands early with the next one right behind it, as when the
+        // USB stack delivers two at once.
+        for (size_t i = 0; i < count; i++) {
+            uint64_t jitter = i % 3 == 1 ? NOMINAL_NS - 50000 : 0;
+            data.time_ns[i] = (i + 1) * NOMINAL_NS - jitter;
+            data.samples[i].time_ns = data.time_ns[i];
+        }
+        data.batch.time_ns = data.time_ns;
+
+        for (size_t c = 0; c < config_count; c++) {
+            test_config(name, &tests[c], &data, &out);
+        }
+    }
+
+    test_scroll_transitions(&defaults);
+    test_gain(&defaults);
+    test_quaternion(&defaults);
+    test_prediction(&defaults);
+    test_absolute(&defaults);
+
+    // The sample times from the last signal, on a quick flick
+    imu_synth_generate(IMU_SYNTH_FAST_FLICK, RATE, data.packets, IMU_SYNTH_PACKET_SIZE,
+                       data.ts, count);
+    test_replay_pace(&defaults, &data);
+
+    printf("test=motion signals=%d configs=%zu checks=%lu failures=%lu\n",
+           IMU_SYNTH_COUNT, config_count, checks, failures);
+
+    free(outputs);
+    free(columns);
+    free(data.samples);
+    free(data.time_ns);
+    free(data.ts);
+    free(data.packets);
+    return failures == 0 ? 0 : 1;
+}
@@ -3,17 +3,58 @@
 
 #include <stdbool.h>
 
+// Pose filtering modes
+typedef enum {
+    FILTER_LEGACY,              // Fixed per-sample smoothing factor
+    FILTER_ONE_EURO             // Speed-adaptive One Euro filter
+} FilterMode;
+
+// Wheel that roll scrolling turns
+typedef enum {
+    SCROLL_VERTICAL,            // REL_WHEEL, buttons 4/5 on X11
+    SCROLL_HORIZONTAL           // REL_HWHEEL, buttons 6/7 on X11
+} ScrollAxis;
+
+// What the glasses stream while tracking is disabled or paused
+typedef enum {
+    IMU_DISABLED_OFF,           // Stop the IMU stream
+    IMU_DISABLED_LOW,           // Stream at the lowest rate
+    IMU_DISABLED_FULL           // Keep streaming at imu_rate
+} ImuDisabledMode;
+
+// IMU sample rates the glasses support (Hz)
+#define IMU_RATE_DEFAULT 120
+
+// Older configs stated deadzone, smoothing and scroll sensitivity per sample;
+// they are converted assuming the rate those values were tuned at
+#define LEGACY_SAMPLE_RATE 120.0f
+
 // Configuration structure
 typedef struct {
     float sensitivity_yaw;      // Sensitivity for horizontal movement
     float sensitivity_pitch;    // Sensitivity for vertical movement
-    float deadzone;             // Minimum movement to register (in degrees)
-    float smoothing;            // Smoothing factor (0.0-1.0)
+    int imu_rate;               // IMU sample rate in Hz (60, 90, 120 or 240)
+    ImuDisabledMode disabled_imu; // IMU stream while tracking is disabled or paused
+    int still_timeout_ms;       // Drop to the lowest IMU rate after the head is still this long (0 = never)
+    float still_threshold;      // Head speed that counts as motion again (degrees/second)
+    float deadzone_speed;       // Minimum head speed to register (degrees/second)
+    float smoothing_ms;         // Smoothing time constant (ms), legacy filter only
+    FilterMode filter;          // Pose filtering mode
+    float euro_min_cutoff;      // One Euro cutoff at rest (Hz), lower = smoother
+    float euro_beta;            // One Euro cutoff increase per degree/second, higher = less lag
     float roll_scroll_threshold; // Roll angle at which to trigger scrolling
-    float scroll_sensitivity;   // Sensitivity for scroll wheel
+    float scroll_hysteresis;    // Scrolling stops this many degrees below the threshold
+    float scroll_speed;         // Scroll lines per second at one degree past the threshold
+    float scroll_curve;         // Lines per second grow with degrees past the threshold to this power
+    float scroll_max_speed;     // Most lines per second (0 = no limit)
+    ScrollAxis scroll_axis;     // Wheel that roll scrolling turns
     bool invert_x;              // Invert horizontal movement
     bool invert_y;              // Invert vertical movement
     bool invert_scroll;         // Invert scroll direction
+    bool use_quaternion;        // Derive movement from the orientation quaternion (roll-compensated)
+    float prediction_ms;        // Extrapolate head pose this far ahead (0 = off)
+    int output_rate;            // Emit one frame per tick at this rate in Hz (0 = per sample)
+    bool absolute_mode;         // Map orientation straight to a screen position (yaw/pitch_range)
     
     // Screen mapping ranges (in degrees)
     float yaw_range;            // Total yaw range to map to screen width
@@ -29,7 +70,14 @@ typedef struct {
 bool load_config_file(const char *path, MouseConfig *config);
 bool save_config_file(const char *path, const MouseConfig *config);
 char* get_user_config_path(void);
-void load_config(MouseConfig *config);
+const char* load_config(MouseConfig *config);
+// Apply one key/value setting; returns false for unknown keys or bad values.
+// The per-sample keys deadzone, smoothing and scroll_sensitivity are still
+// accepted and converted.
+bool set_config_value(MouseConfig *config, const char *key, const char *value);
+// Per-sample smoothing factor at LEGACY_SAMPLE_RATE for a time constant
+float legacy_smoothing_factor(float smoothing_ms);
+bool imu_rate_supported(int rate);
 void save_config(const MouseConfig *config);
 
 #endif // MOUSE_CONFIG_H
\ No newline at end of file
@@ -0,0 +1,84 @@
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "pose_export.h"
+#include "motion_pipeline.h"
+
+// Create the shared memory segment and map it for writing
+bool pose_export_open(PoseExportWriter *writer) {
+    const char *name = pose_export_name();
+    writer->shared = NULL;
+    writer->count = 0;
+    
+    // Readable by everyone: it only holds the head pose, and consumers
+    // usually run as the desktop user while the daemon may run as root
+    int fd = shm_open(name, O_CREAT | O_RDWR | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        perror("Failed to create pose shared memory");
+        return false;
+    }
+    fchmod(fd, 0644);
+    
+    if (ftruncate(fd, sizeof(PoseExportShared)) < 0) {
+        perror("Failed to size pose shared memory");
+        close(fd);
+        shm_unlink(name);
+        return false;
+    }
+    
+    void *map = mmap(NULL, sizeof(PoseExportShared), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        perror("Failed to map pose shared memory");
+        shm_unlink(name);
+        return false;
+    }
+    
+    PoseExportShared *shared = (PoseExportShared *)map;
+    memset(shared, 0, sizeof(*shared));
+    shared->version = POSE_EXPORT_VERSION;
+    shared->size = sizeof(PoseExportShared);
+    // Magic goes last so readers never accept a half-initialized segment
+    __atomic_store_n(&shared->magic, POSE_EXPORT_MAGIC, __ATOMIC_RELEASE);
+    
+    writer->shared = shared;
+    return true;
+}
+
+void pose_export_publish(PoseExportWriter *writer, const MotionSample *sample) {
+    PoseExportShared *shared = writer->shared;
+    if (!shared) return;
+    
+    // Odd sequence while the sample is being rewritten
+    uint32_t seq = shared->seq;
+    __atomic_store_n(&shared->seq, seq + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    
+    PoseExportSample *out = &shared->sample;
+    out->roll = sample->roll;
+    out->pitch = sample->pitch;
+    out->yaw = sample->yaw;
+    out->quat_w = sample->quat_w;
+    out->quat_x = sample->quat_x;
+    out->quat_y = sample->quat_y;
+    out->quat_z = sample->quat_z;
+    out->have_quaternion = sample->have_quaternion;
+    out->ts = sample->ts;
+    out->arrival_ns = sample->arrival_ns;
+    out->count = ++writer->count;
+    
+    __atomic_store_n(&shared->seq, seq + 2, __ATOMIC_RELEASE);
+}
+
+// Unmap and remove the segment; mapped readers keep their (now frozen) copy
+void pose_export_close(PoseExportWriter *writer) {
+    if (!writer->shared) return;
+    
+    munmap(writer->shared, sizeof(PoseExportShared));
+    writer->shared = NULL;
+    shm_unlink(pose_export_name());
+}
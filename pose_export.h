@@ -0,0 +1,115 @@
+#ifndef POSE_EXPORT_H
+#define POSE_EXPORT_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+// Latest head pose, exported through POSIX shared memory for local consumers
+// that want it every frame (compositor plugins, overlays) without a socket
+// round trip. The daemon writes each IMU sample under a seqlock; readers map
+// the segment once and then read with no syscalls and no locks.
+//
+// This header is all a consumer needs: it only depends on libc and uses GCC
+// atomic builtins, so it can be included from C or C++.
+//
+//   const PoseExportShared *pose = pose_export_map(NULL);
+//   PoseExportSample sample;
+//   if (pose && pose_export_read(pose, &sample)) { ... }
+
+#define POSE_EXPORT_NAME_ENV    "VITURE_MOUSE_POSE_SHM"
+#define POSE_EXPORT_NAME        "/viture-head-mouse-pose"
+#define POSE_EXPORT_MAGIC       0x45504856u     // "VHPE"
+#define POSE_EXPORT_VERSION     1
+
+// Attempts pose_export_read makes before giving up on a busy writer
+#define POSE_EXPORT_READ_TRIES  4
+
+typedef struct {
+    float roll;                 // Degrees, as decoded from the SDK packet
+    float pitch;
+    float yaw;
+    float quat_w;               // Orientation quaternion, valid if have_quaternion
+    float quat_x;
+    float quat_y;
+    float quat_z;
+    uint32_t have_quaternion;
+    uint32_t ts;                // SDK timestamp
+    uint64_t arrival_ns;        // CLOCK_MONOTONIC when the daemon received it
+    uint64_t count;             // Samples published since the daemon started
+} PoseExportSample;
+
+typedef struct {
+    uint32_t magic;             // POSE_EXPORT_MAGIC
+    uint32_t version;           // POSE_EXPORT_VERSION
+    uint32_t size;              // sizeof(PoseExportShared)
+    uint32_t seq;               // Seqlock: odd while the writer is mid-update
+    PoseExportSample sample;
+} PoseExportShared;
+
+// Name of the shared memory segment
+static inline const char* pose_export_name(void) {
+    const char *name = getenv(POSE_EXPORT_NAME_ENV);
+    return name ? name : POSE_EXPORT_NAME;
+}
+
+// Map the segment read-only (NULL name uses the default). Returns NULL if the
+// daemon isn't running or the layout doesn't match this header.
+static inline const PoseExportShared* pose_export_map(const char *name) {
+    int fd = shm_open(name ? name : pose_export_name(), O_RDONLY, 0);
+    if (fd < 0) return NULL;
+
+    void *map = mmap(NULL, sizeof(PoseExportShared), PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) return NULL;
+
+    const PoseExportShared *shared = (const PoseExportShared *)map;
+    if (shared->magic != POSE_EXPORT_MAGIC || shared->version != POSE_EXPORT_VERSION ||
+        shared->size != sizeof(PoseExportShared)) {
+        munmap(map, sizeof(PoseExportShared));
+        return NULL;
+    }
+    return shared;
+}
+
+static inline void pose_export_unmap(const PoseExportShared *shared) {
+    munmap((void *)shared, sizeof(PoseExportShared));
+}
+
+// Copy out a consistent sample. Wait-free: a read that overlaps a write is
+// retried a bounded number of times, and false means try again next frame
+// (it only happens if the writer is preempted mid-update).
+static inline bool pose_export_read(const PoseExportShared *shared, PoseExportSample *sample) {
+    for (int i = 0; i < POSE_EXPORT_READ_TRIES; i++) {
+        uint32_t begin = __atomic_load_n(&shared->seq, __ATOMIC_ACQUIRE);
+        if (begin & 1) continue;
+
+        memcpy(sample, (const void *)&shared->sample, sizeof(*sample));
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+
+        if (__atomic_load_n(&shared->seq, __ATOMIC_RELAXED) == begin) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Writer side, used by the daemon (pose_export.c)
+typedef struct {
+    PoseExportShared *shared;   // NULL when not exporting
+    uint64_t count;
+} PoseExportWriter;
+
+struct MotionSample;
+
+bool pose_export_open(PoseExportWriter *writer);
+// Publish one sample. Single writer: call from the IMU callback thread only.
+void pose_export_publish(PoseExportWriter *writer, const struct MotionSample *sample);
+void pose_export_close(PoseExportWriter *writer);
+
+#endif // POSE_EXPORT_H
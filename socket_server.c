@@ -1,4 +1,6 @@
+#define _GNU_SOURCE
 #include <stdio.h>
+#include <stdarg.h>
 #include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
@@ -7,11 +9,27 @@
 #include <errno.h>
 #include <fcntl.h>
 #include <signal.h>
+#include <time.h>
 #include <sys/stat.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
 #include <pwd.h>
 
 #include "socket_server.h"
 
+// epoll tags: the shutdown eventfd, the listening socket, the subscription
+// timer, then client slots
+#define EVENT_WAKE   0
+#define EVENT_LISTEN 1
+#define EVENT_TIMER  2
+#define EVENT_CLIENT 3
+
+#define QUEUE_MASK (SUBSCRIBE_QUEUE - 1)
+
+// First file descriptor passed by systemd socket activation
+#define LISTEN_FDS_START 3
+
 // Get socket path from environment or use default
 static const char* get_socket_path() {
     const char *path = getenv(SOCKET_PATH_ENV);
@@ -35,47 +53,306 @@ static void get_original_user(uid_t *uid, gid_t *gid) {
     }
 }
 
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+static void close_client(SocketServer *server, SocketClient *client);
+
+// Watch a client for writability only while it has queued output
+static void watch_writable(SocketServer *server, SocketClient *client, bool writable) {
+    if (client->want_write == writable) return;
+    
+    struct epoll_event ev = {
+        .events = EPOLLIN | (writable ? EPOLLOUT : 0),
+        .data.u64 = EVENT_CLIENT + (client - server->clients)
+    };
+    epoll_ctl(server->epoll_fd, EPOLL_CTL_MOD, client->fd, &ev);
+    client->want_write = writable;
+}
+
+// Write the unsent part of a line. False if the socket is full (or failed,
+// closing the client) before all of it went out.
+static bool send_pending(SocketServer *server, SocketClient *client, const char *text,
+                         size_t length, size_t *sent) {
+    while (*sent < length) {
+        ssize_t n = send(client->fd, text + *sent, length - *sent, MSG_NOSIGNAL);
+        if (n < 0) {
+            if (errno == EAGAIN || errno == EINTR) {
+                watch_writable(server, client, true);
+            } else {
+                close_client(server, client);
+            }
+            return false;
+        }
+        *sent += n;
+    }
+    return true;
+}
+
+// Write as much of a client's responses, then its queue, as the socket will
+// take
+static void flush_queue(SocketServer *server, SocketClient *client) {
+    if (!send_pending(server, client, client->reply, client->reply_length, &client->reply_sent)) {
+        return;
+    }
+    client->reply_length = 0;
+    client->reply_sent = 0;
+    
+    while (client->queue_tail != client->queue_head) {
+        SubscribeRecord *record = &client->queue[client->queue_tail & QUEUE_MASK];
+        if (!send_pending(server, client, record->text, record->length, &client->queue_sent)) {
+            return;
+        }
+        client->queue_tail++;
+        client->queue_sent = 0;
+    }
+    watch_writable(server, client, false);
+}
+
+// Queue a line for a subscriber, dropping the oldest record when full
+static void queue_record(SocketClient *client, const char *text) {
+    if (client->queue_head - client->queue_tail == SUBSCRIBE_QUEUE) {
+        unsigned int oldest = client->queue_tail;
+        if (client->queue_sent > 0) {
+            // The oldest record is partly written, drop the one after it instead
+            client->queue[(oldest + 1) & QUEUE_MASK] = client->queue[oldest & QUEUE_MASK];
+        }
+        client->queue_tail++;
+        client->dropped++;
+    }
+    
+    SubscribeRecord *record = &client->queue[client->queue_head & QUEUE_MASK];
+    snprintf(record->text, sizeof(record->text), "%s", text);
+    record->length = strlen(record->text);
+    client->queue_head++;
+}
+
+// Format an output line. One that doesn't fit is cut short, but it always
+// ends in a newline so the client's line framing survives.
+static void format_line(char *line, size_t size, const char *format, ...) {
+    va_list args;
+    va_start(args, format);
+    int length = vsnprintf(line, size, format, args);
+    va_end(args);
+    
+    if (length < 0) {
+        snprintf(line, size, "ERROR: internal error\n");
+    } else if ((size_t)length >= size) {
+        line[size - 2] = '\n';
+    }
+}
+
+// Arm the subscription timer at the fastest subscriber's rate, or disarm it
+static void update_timer(SocketServer *server) {
+    int rate = 0;
+    int subscribers = 0;
+    for (int i = 0; i < SOCKET_MAX_CLIENTS; i++) {
+        SocketClient *client = &server->clients[i];
+        if (client->fd >= 0 && client->rate > 0) {
+            subscribers++;
+            if (client->rate > rate) rate = client->rate;
+        }
+    }
+    atomic_store(&server->subscribers, subscribers);
+    if (rate == server->timer_rate) return;
+    
+    // At 1 Hz the period is a whole second, which tv_nsec can't hold
+    long long period_ns = rate > 0 ? 1000000000LL / rate : 0;
+    struct timespec period = { .tv_sec = period_ns / 1000000000LL, .tv_nsec = period_ns % 1000000000LL };
+    struct itimerspec spec = { .it_interval = period, .it_value = period };
+    if (timerfd_settime(server->timer_fd, 0, &spec, NULL) < 0) {
+        perror("Failed to arm subscription timer");
+        return;
+    }
+    server->timer_rate = rate;
+}
+
+// Generate a record for every subscriber that is due one
+static void send_records(SocketServer *server) {
+    uint64_t now = now_ns();
+    bool enabled = server->get_enabled ? server->get_enabled() : false;
+    
+    pthread_mutex_lock(&server->telemetry.lock);
+    float yaw = server->telemetry.yaw;
+    float pitch = server->telemetry.pitch;
+    float roll = server->telemetry.roll;
+    long long total_x = server->telemetry.total_x;
+    long long total_y = server->telemetry.total_y;
+    long long total_scroll = server->telemetry.total_scroll;
+    pthread_mutex_unlock(&server->telemetry.lock);
+    
+    for (int i = 0; i < SOCKET_MAX_CLIENTS; i++) {
+        SocketClient *client = &server->clients[i];
+        if (client->fd < 0 || client->rate == 0 || now < client->next_due_ns) continue;
+        
+        // Stay on the client's own schedule, but don't try to catch up after a stall
+        uint64_t interval = 1000000000ull / client->rate;
+        client->next_due_ns += interval;
+        if (client->next_due_ns <= now) {
+            client->next_due_ns = now + interval;
+        }
+        
+        char record[SUBSCRIBE_RECORD_MAX];
+        format_line(record, sizeof(record),
+                    "seq=%llu t=%llu yaw=%.2f pitch=%.2f roll=%.2f dx=%lld dy=%lld scroll=%lld"
+                    " enabled=%d dropped=%llu\n",
+                    client->seq++, (unsigned long long)(now / 1000000),
+                    yaw, pitch, roll,
+                    total_x - client->seen_x,
+                    total_y - client->seen_y,
+                    total_scroll - client->seen_scroll,
+                    enabled, client->dropped);
+        client->seen_x = total_x;
+        client->seen_y = total_y;
+        client->seen_scroll = total_scroll;
+        
+        queue_record(client, record);
+        if (!client->want_write) {
+            flush_queue(server, client);
+        }
+    }
+}
+
+// Start or retune a subscription
+static bool subscribe_client(SocketServer *server, SocketClient *client, const char *arg) {
+    int rate = SUBSCRIBE_DEFAULT_RATE;
+    if (*arg) {
+        char *end;
+        long value = strtol(arg, &end, 10);
+        if (*end != '\0' || value < 1 || value > SUBSCRIBE_MAX_RATE) {
+            return false;
+        }
+        rate = (int)value;
+    }
+    
+    if (client->rate == 0) {
+        // Start with movement from now on, not everything since startup
+        pthread_mutex_lock(&server->telemetry.lock);
+        client->seen_x = server->telemetry.total_x;
+        client->seen_y = server->telemetry.total_y;
+        client->seen_scroll = server->telemetry.total_scroll;
+        pthread_mutex_unlock(&server->telemetry.lock);
+        client->seq = 0;
+        client->dropped = 0;
+    }
+    client->rate = rate;
+    client->next_due_ns = now_ns();
+    update_timer(server);
+    return true;
+}
+
+// Send a command response, keeping what the socket doesn't take yet. Once
+// subscribed, the only responses are short and go in line with the records.
+// A client that stops reading its responses until they fill the buffer is
+// dropped rather than losing any.
+static void reply(SocketServer *server, SocketClient *client, const char *response) {
+    if (client->rate > 0) {
+        queue_record(client, response);
+    } else {
+        if (client->reply_sent > 0) {
+            client->reply_length -= client->reply_sent;
+            memmove(client->reply, client->reply + client->reply_sent, client->reply_length);
+            client->reply_sent = 0;
+        }
+        size_t length = strlen(response);
+        if (client->reply_length + length > sizeof(client->reply)) {
+            fprintf(stderr, "Warning: closing socket client that isn't reading responses\n");
+            close_client(server, client);
+            return;
+        }
+        memcpy(client->reply + client->reply_length, response, length);
+        client->reply_length += length;
+    }
+    if (!client->want_write) {
+        flush_queue(server, client);
+    }
+}
+
 // Handle a client command
-static void handle_command(SocketServer *server, int client_fd, const char *cmd) {
-    char response[256];
+static void handle_command(SocketServer *server, SocketClient *client, const char *cmd) {
+    char response[SOCKET_RESPONSE_MAX];
     
-    if (strcmp(cmd, "toggle") == 0) {
+    if (client->rate > 0 && strcmp(cmd, "subscribe") != 0 && strncmp(cmd, "subscribe ", 10) != 0) {
+        // A subscribed connection only carries records from here on
+        format_line(response, sizeof(response), "ERROR: connection is subscribed\n");
+        
+    } else if (strcmp(cmd, "subscribe") == 0 || strncmp(cmd, "subscribe ", 10) == 0) {
+        const char *arg = cmd[9] == ' ' ? cmd + 10 : "";
+        if (subscribe_client(server, client, arg)) {
+            format_line(response, sizeof(response), "OK: subscribed rate=%d\n", client->rate);
+        } else {
+            format_line(response, sizeof(response), "ERROR: invalid rate (1-%d)\n", SUBSCRIBE_MAX_RATE);
+        }
+        
+    } else if (strcmp(cmd, "toggle") == 0) {
         if (server->on_toggle) {
             server->on_toggle();
         }
         bool enabled = server->get_enabled ? server->get_enabled() : false;
-        snprintf(response, sizeof(response), "OK: tracking %s\n", enabled ? "enabled" : "disabled");
+        format_line(response, sizeof(response), "OK: tracking %s\n", enabled ? "enabled" : "disabled");
         
     } else if (strcmp(cmd, "recenter") == 0) {
         if (server->on_recenter) {
             server->on_recenter();
         }
-        snprintf(response, sizeof(response), "OK: recentered\n");
+        format_line(response, sizeof(response), "OK: recentered\n");
         
     } else if (strcmp(cmd, "pause") == 0) {
         if (server->on_pause) {
             server->on_pause();
         }
-        snprintf(response, sizeof(response), "OK: paused\n");
+        format_line(response, sizeof(response), "OK: paused\n");
         
     } else if (strcmp(cmd, "resume") == 0) {
         if (server->on_resume) {
             server->on_resume();
         }
-        snprintf(response, sizeof(response), "OK: resumed\n");
+        format_line(response, sizeof(response), "OK: resumed\n");
         
     } else if (strcmp(cmd, "reload") == 0) {
         if (server->on_reload) {
             server->on_reload();
         }
-        snprintf(response, sizeof(response), "OK: configuration reloaded\n");
+        format_line(response, sizeof(response), "OK: configuration reloaded\n");
         
     } else if (strcmp(cmd, "status") == 0) {
         bool enabled = server->get_enabled ? server->get_enabled() : false;
         float sensitivity = server->get_sensitivity ? server->get_sensitivity() : 0.0f;
-        snprintf(response, sizeof(response), "OK: enabled=%s sensitivity=%.1f\n", 
-                 enabled ? "true" : "false", sensitivity);
+        format_line(response, sizeof(response), "OK: enabled=%s sensitivity=%.1f\n", 
+                    enabled ? "true" : "false", sensitivity);
                  
+    } else if (strcmp(cmd, "stats") == 0) {
+        char stats[SOCKET_RESPONSE_MAX - sizeof("OK: \n") + 1] = "";
+        if (server->get_stats) {
+            server->get_stats(stats, sizeof(stats));
+        }
+        format_line(response, sizeof(response), "OK: %s\n", stats);
+        
+    } else if (strcmp(cmd, "latency") == 0) {
+        char report[SOCKET_RESPONSE_MAX - sizeof("OK: \n") + 1] = "";
+        if (server->get_latency) {
+            server->get_latency(report, sizeof(report));
+        }
+        format_line(response, sizeof(response), "OK: %s\n", report);
+        
+    } else if (strcmp(cmd, "latency reset") == 0) {
+        if (server->reset_latency) {
+            server->reset_latency();
+        }
+        format_line(response, sizeof(response), "OK: latency histograms reset\n");
+        
+    } else if (strncmp(cmd, "set ", 4) == 0) {
+        char key[64], value[64];
+        if (sscanf(cmd + 4, "%63s %63s", key, value) == 2 &&
+            server->set_option && server->set_option(key, value)) {
+            format_line(response, sizeof(response), "OK: %s set to %s\n", key, value);
+        } else {
+            format_line(response, sizeof(response), "ERROR: invalid setting\n");
+        }
+        
     } else if (strncmp(cmd, "sensitivity ", 12) == 0) {
         const char *arg = cmd + 12;
         if (arg[0] == '+' || arg[0] == '-') {
@@ -85,50 +362,66 @@ static void handle_command(SocketServer *server, int client_fd, const char *cmd)
                 server->adjust_sensitivity(delta);
             }
             float new_sens = server->get_sensitivity ? server->get_sensitivity() : 0.0f;
-            snprintf(response, sizeof(response), "OK: sensitivity adjusted to %.1f\n", new_sens);
+            format_line(response, sizeof(response), "OK: sensitivity adjusted to %.1f\n", new_sens);
         } else {
             // Absolute value
             float value = atof(arg);
             if (value > 0 && server->set_sensitivity) {
                 server->set_sensitivity(value);
-                snprintf(response, sizeof(response), "OK: sensitivity set to %.1f\n", value);
+                format_line(response, sizeof(response), "OK: sensitivity set to %.1f\n", value);
             } else {
-                snprintf(response, sizeof(response), "ERROR: invalid sensitivity value\n");
+                format_line(response, sizeof(response), "ERROR: invalid sensitivity value\n");
             }
         }
         
     } else {
-        snprintf(response, sizeof(response), "ERROR: unknown command '%s'\n", cmd);
+        format_line(response, sizeof(response), "ERROR: unknown command '%s'\n", cmd);
     }
     
-    // Send response
-    send(client_fd, response, strlen(response), 0);
+    reply(server, client, response);
 }
 
-// Socket server thread
-static void* socket_server_thread(void *arg) {
-    SocketServer *server = (SocketServer *)arg;
-    struct sockaddr_un addr;
+// The listening socket passed by systemd socket activation (the first one,
+// if there are several), or -1 when not socket activated
+static int activated_socket(void) {
+    const char *pid = getenv("LISTEN_PID");
+    const char *fds = getenv("LISTEN_FDS");
+    if (!pid || !fds || atol(pid) != (long)getpid() || atoi(fds) < 1) {
+        return -1;
+    }
     
-    // Block SIGPIPE to prevent crashes on broken connections
-    sigset_t set;
-    sigemptyset(&set);
-    sigaddset(&set, SIGPIPE);
-    pthread_sigmask(SIG_BLOCK, &set, NULL);
+    // Don't pass them on to anything we start
+    unsetenv("LISTEN_PID");
+    unsetenv("LISTEN_FDS");
+    unsetenv("LISTEN_FDNAMES");
+    
+    int fd = LISTEN_FDS_START;
+    int listening = 0;
+    socklen_t length = sizeof(listening);
+    struct stat st;
+    if (fstat(fd, &st) < 0 || !S_ISSOCK(st.st_mode) ||
+        getsockopt(fd, SOL_SOCKET, SO_ACCEPTCONN, &listening, &length) < 0 || !listening) {
+        fprintf(stderr, "Warning: Ignoring socket activation, fd %d is not a listening socket\n", fd);
+        return -1;
+    }
+    
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+    fcntl(fd, F_SETFD, FD_CLOEXEC);
+    return fd;
+}
+
+// Create, bind and listen on the control socket ourselves
+static bool bind_socket(SocketServer *server, const char *socket_path) {
+    struct sockaddr_un addr;
     
     // Create socket
-    server->socket_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    server->socket_fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
     if (server->socket_fd < 0) {
         perror("Failed to create socket");
-        return NULL;
+        return false;
     }
     
-    // Make socket non-blocking
-    int flags = fcntl(server->socket_fd, F_GETFL, 0);
-    fcntl(server->socket_fd, F_SETFL, flags | O_NONBLOCK);
-    
     // Remove existing socket file
-    const char *socket_path = get_socket_path();
     unlink(socket_path);
     
     // Bind socket
@@ -139,7 +432,7 @@ static void* socket_server_thread(void *arg) {
     if (bind(server->socket_fd, (struct sockaddr*)&addr, sizeof(addr)) < 0) {
         perror("Failed to bind socket");
         close(server->socket_fd);
-        return NULL;
+        return false;
     }
     
     // Set socket permissions so original user can access it when running under sudo
@@ -158,70 +451,265 @@ static void* socket_server_thread(void *arg) {
     }
     
     // Listen for connections
-    if (listen(server->socket_fd, 5) < 0) {
+    if (listen(server->socket_fd, SOMAXCONN) < 0) {
         perror("Failed to listen on socket");
         close(server->socket_fd);
-        return NULL;
-    }
-    
-    printf("Socket server listening on %s\n", socket_path);
-    
-    // Main server loop
-    while (server->running) {
-        fd_set readfds;
-        struct timeval timeout;
-        
-        FD_ZERO(&readfds);
-        FD_SET(server->socket_fd, &readfds);
-        
-        timeout.tv_sec = 0;
-        timeout.tv_usec = 100000; // 100ms timeout
-        
-        int result = select(server->socket_fd + 1, &readfds, NULL, NULL, &timeout);
-        
-        if (result > 0 && FD_ISSET(server->socket_fd, &readfds)) {
-            // Accept new connection
-            int client_fd = accept(server->socket_fd, NULL, NULL);
-            if (client_fd >= 0) {
-                // Read command
-                char buffer[256];
-                memset(buffer, 0, sizeof(buffer));
-                
-                ssize_t n = recv(client_fd, buffer, sizeof(buffer) - 1, 0);
-                if (n > 0) {
-                    // Remove trailing newline
-                    if (buffer[n-1] == '\n') buffer[n-1] = '\0';
-                    
-                    // Handle command
-                    handle_command(server, client_fd, buffer);
+        unlink(socket_path);
+        return false;
+    }
+    return true;
+}
+
+// Remove the socket file, unless systemd owns it
+static void unlink_socket(SocketServer *server) {
+    if (!server->activated) {
+        unlink(get_socket_path());
+    }
+}
+
+// Set up the listening socket, epoll set and shutdown eventfd
+static bool setup_server(SocketServer *server) {
+    const char *socket_path = get_socket_path();
+    server->socket_fd = activated_socket();
+    server->activated = server->socket_fd >= 0;
+    if (!server->activated && !bind_socket(server, socket_path)) {
+        return false;
+    }
+    
+    // Everything the server waits on goes in one epoll set, so it sleeps
+    // until there's actually something to do
+    server->epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    server->wake_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    server->timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (server->epoll_fd < 0 || server->wake_fd < 0 || server->timer_fd < 0) {
+        perror("Failed to set up socket server events");
+        if (server->epoll_fd >= 0) close(server->epoll_fd);
+        if (server->wake_fd >= 0) close(server->wake_fd);
+        if (server->timer_fd >= 0) close(server->timer_fd);
+        close(server->socket_fd);
+        unlink_socket(server);
+        return false;
+    }
+    
+    struct epoll_event ev = { .events = EPOLLIN, .data.u64 = EVENT_WAKE };
+    epoll_ctl(server->epoll_fd, EPOLL_CTL_ADD, server->wake_fd, &ev);
+    ev.data.u64 = EVENT_LISTEN;
+    epoll_ctl(server->epoll_fd, EPOLL_CTL_ADD, server->socket_fd, &ev);
+    ev.data.u64 = EVENT_TIMER;
+    epoll_ctl(server->epoll_fd, EPOLL_CTL_ADD, server->timer_fd, &ev);
+    server->timer_rate = 0;
+    
+    for (int i = 0; i < SOCKET_MAX_CLIENTS; i++) {
+        server->clients[i].fd = -1;
+    }
+    pthread_mutex_init(&server->telemetry.lock, NULL);
+    atomic_store(&server->subscribers, 0);
+    
+    if (server->activated) {
+        printf("Socket server listening on the socket passed by systemd\n");
+    } else {
+        printf("Socket server listening on %s\n", socket_path);
+    }
+    return true;
+}
+
+static void close_client(SocketServer *server, SocketClient *client) {
+    epoll_ctl(server->epoll_fd, EPOLL_CTL_DEL, client->fd, NULL);
+    close(client->fd);
+    client->fd = -1;
+    client->used = 0;
+    if (client->rate > 0) {
+        client->rate = 0;
+        update_timer(server);
+    }
+}
+
+// Accept every pending connection
+static void accept_clients(SocketServer *server) {
+    int client_fd;
+    while ((client_fd = accept4(server->socket_fd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC)) >= 0) {
+        int slot = -1;
+        for (int i = 0; i < SOCKET_MAX_CLIENTS; i++) {
+            if (server->clients[i].fd < 0) {
+                slot = i;
+                break;
+            }
+        }
+        if (slot < 0) {
+            const char *busy = "ERROR: too many clients\n";
+            send(client_fd, busy, strlen(busy), MSG_NOSIGNAL);
+            close(client_fd);
+            continue;
+        }
+        
+        SocketClient *client = &server->clients[slot];
+        client->fd = client_fd;
+        client->used = 0;
+        client->reply_length = 0;
+        client->reply_sent = 0;
+        client->rate = 0;
+        client->queue_head = 0;
+        client->queue_tail = 0;
+        client->queue_sent = 0;
+        client->want_write = false;
+        
+        struct epoll_event ev = { .events = EPOLLIN, .data.u64 = EVENT_CLIENT + slot };
+        epoll_ctl(server->epoll_fd, EPOLL_CTL_ADD, client_fd, &ev);
+    }
+}
+
+// Read from a client and run every complete line it has sent. Clients may
+// pipeline several commands; responses go back in order, one line each.
+static void serve_client(SocketServer *server, SocketClient *client) {
+    ssize_t n = recv(client->fd, client->buffer + client->used,
+                     sizeof(client->buffer) - client->used - 1, 0);
+    if (n < 0 && (errno == EAGAIN || errno == EINTR)) {
+        return;
+    }
+    bool closing = n <= 0;
+    if (n > 0) {
+        client->used += n;
+    }
+    client->buffer[client->used] = '\0';
+    
+    char *line = client->buffer;
+    char *newline;
+    while ((newline = strchr(line, '\n')) != NULL) {
+        *newline = '\0';
+        if (newline > line && newline[-1] == '\r') newline[-1] = '\0';
+        if (*line) {
+            handle_command(server, client, line);
+            if (client->fd < 0) return;
+        }
+        line = newline + 1;
+    }
+    
+    // A client that hangs up after an unterminated command still gets it run
+    if (closing) {
+        if (*line) {
+            handle_command(server, client, line);
+            if (client->fd < 0) return;
+        }
+        close_client(server, client);
+        return;
+    }
+    
+    // Keep the partial line for the next read
+    client->used = strlen(line);
+    memmove(client->buffer, line, client->used);
+    if (client->used == sizeof(client->buffer) - 1) {
+        reply(server, client, "ERROR: command too long\n");
+        close_client(server, client);
+    }
+}
+
+// Socket server thread
+static void* socket_server_thread(void *arg) {
+    SocketServer *server = (SocketServer *)arg;
+    struct epoll_event events[16];
+    
+    // Block SIGPIPE to prevent crashes on broken connections
+    sigset_t set;
+    sigemptyset(&set);
+    sigaddset(&set, SIGPIPE);
+    pthread_sigmask(SIG_BLOCK, &set, NULL);
+    
+    // Main server loop: no timeout, stop_socket_server wakes us via wake_fd
+    bool running = true;
+    while (running) {
+        int count = epoll_wait(server->epoll_fd, events, 16, -1);
+        if (count < 0) {
+            if (errno == EINTR) continue;
+            perror("Socket server epoll_wait failed");
+            break;
+        }
+        
+        for (int i = 0; i < count; i++) {
+            uint64_t tag = events[i].data.u64;
+            if (tag == EVENT_WAKE) {
+                running = false;
+            } else if (tag == EVENT_LISTEN) {
+                accept_clients(server);
+            } else if (tag == EVENT_TIMER) {
+                uint64_t expirations;
+                if (read(server->timer_fd, &expirations, sizeof(expirations)) == sizeof(expirations)) {
+                    send_records(server);
+                }
+            } else {
+                SocketClient *client = &server->clients[tag - EVENT_CLIENT];
+                if (client->fd >= 0 && (events[i].events & EPOLLOUT)) {
+                    flush_queue(server, client);
+                }
+                if (client->fd >= 0 && (events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR))) {
+                    serve_client(server, client);
                 }
-                
-                close(client_fd);
             }
         }
     }
     
-    // Cleanup
-    close(server->socket_fd);
-    unlink(socket_path);
+    // Cleanup; the server's own fds are closed by whoever stops it
+    for (int i = 0; i < SOCKET_MAX_CLIENTS; i++) {
+        if (server->clients[i].fd >= 0) {
+            close_client(server, &server->clients[i]);
+        }
+    }
     
     return NULL;
 }
 
+static void close_server(SocketServer *server) {
+    close(server->socket_fd);
+    close(server->epoll_fd);
+    close(server->wake_fd);
+    close(server->timer_fd);
+    unlink_socket(server);
+}
+
 // Start the socket server
 bool start_socket_server(SocketServer *server) {
-    server->running = true;
+    if (!setup_server(server)) {
+        return false;
+    }
     
     if (pthread_create(&server->thread, NULL, socket_server_thread, server) != 0) {
         perror("Failed to create socket server thread");
+        close_server(server);
         return false;
     }
     
+    server->running = true;
     return true;
 }
 
 // Stop the socket server
 void stop_socket_server(SocketServer *server) {
+    if (!server->running) return;
     server->running = false;
+    
+    uint64_t one = 1;
+    if (write(server->wake_fd, &one, sizeof(one)) < 0) {
+        perror("Failed to wake socket server");
+    }
     pthread_join(server->thread, NULL);
-}
\ No newline at end of file
+    close_server(server);
+}
+
+void socket_server_publish_pose(SocketServer *server, float yaw, float pitch, float roll) {
+    if (atomic_load_explicit(&server->subscribers, memory_order_relaxed) == 0) return;
+    
+    pthread_mutex_lock(&server->telemetry.lock);
+    server->telemetry.yaw = yaw;
+    server->telemetry.pitch = pitch;
+    server->telemetry.roll = roll;
+    pthread_mutex_unlock(&server->telemetry.lock);
+}
+
+void socket_server_publish_motion(SocketServer *server, int move_x, int move_y, int scroll) {
+    if (atomic_load_explicit(&server->subscribers, memory_order_relaxed) == 0) return;
+    
+    pthread_mutex_lock(&server->telemetry.lock);
+    server->telemetry.total_x += move_x;
+    server->telemetry.total_y += move_y;
+    server->telemetry.total_scroll += scroll;
+    pthread_mutex_unlock(&server->telemetry.lock);
+}
@@ -1,7 +1,10 @@
 #ifndef SOCKET_SERVER_H
 #define SOCKET_SERVER_H
 
+#include <stdatomic.h>
 #include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
 #include <pthread.h>
 
 // Socket path
@@ -9,11 +12,83 @@
 #define DEFAULT_SOCKET_PATH "/tmp/viture-head-mouse.sock"
 #define USER_SOCKET_PATH "/tmp/viture-head-mouse-user.sock"
 
+// Clients connected at once, the longest command line accepted and the
+// longest response line sent
+#define SOCKET_MAX_CLIENTS 16
+#define SOCKET_LINE_MAX 256
+#define SOCKET_RESPONSE_MAX 512
+
+// Subscription streams: record rates in Hz, and records buffered per
+// subscriber (power of two) before the oldest are dropped
+#define SUBSCRIBE_DEFAULT_RATE 30
+#define SUBSCRIBE_MAX_RATE 1000
+#define SUBSCRIBE_QUEUE 32
+#define SUBSCRIBE_RECORD_MAX 160
+
+// A queued subscription record
+typedef struct {
+    char text[SUBSCRIBE_RECORD_MAX];
+    size_t length;
+} SubscribeRecord;
+
+// A connected client. Connections are long-lived: commands are newline
+// terminated and may be pipelined, each gets a one-line response. Responses
+// the socket doesn't take straight away wait in a small buffer of their own,
+// so a client that is slow to read still gets them whole and in order.
+//
+// After "subscribe" the connection becomes a stream of one-line records.
+// Records are queued per client and written as the socket accepts them; a
+// subscriber that can't keep up loses its oldest records, it never slows
+// down anything else.
+typedef struct {
+    int fd;                     // -1 when the slot is free
+    char buffer[SOCKET_LINE_MAX];
+    size_t used;                // Bytes of partial command in buffer
+    char reply[2 * SOCKET_RESPONSE_MAX];    // Responses not written yet
+    size_t reply_length;
+    size_t reply_sent;          // Bytes of reply already written
+
+    // Subscription, rate is 0 when not subscribed
+    int rate;
+    uint64_t next_due_ns;
+    unsigned long long seq;     // Records generated, including dropped ones
+    unsigned long long dropped;
+    long long seen_x;           // Motion totals already reported
+    long long seen_y;
+    long long seen_scroll;
+    SubscribeRecord queue[SUBSCRIBE_QUEUE];
+    unsigned int queue_head;
+    unsigned int queue_tail;
+    size_t queue_sent;          // Bytes of the oldest record already written
+    bool want_write;            // Waiting for EPOLLOUT
+} SocketClient;
+
+// What the daemon is doing, as published from its emitter thread
+typedef struct {
+    pthread_mutex_t lock;
+    float yaw;
+    float pitch;
+    float roll;
+    long long total_x;          // Running totals of emitted motion
+    long long total_y;
+    long long total_scroll;
+} SocketTelemetry;
+
 // Socket server state
 typedef struct {
     int socket_fd;
+    bool activated;             // socket_fd came from systemd socket activation
+    int epoll_fd;
+    int wake_fd;                // eventfd that tells the server thread to exit
+    int timer_fd;               // Subscription record timer
+    int timer_rate;             // Rate the timer is armed at, 0 = disarmed
     pthread_t thread;
     bool running;
+    SocketClient clients[SOCKET_MAX_CLIENTS];
+    
+    // Subscription data, publishing is skipped while nobody is subscribed
+    SocketTelemetry telemetry;
+    atomic_int subscribers;
     
     // Callbacks for commands
     void (*on_toggle)(void);
@@ -25,6 +100,10 @@ typedef struct {
     float (*get_sensitivity)(void);
     void (*set_sensitivity)(float value);
     void (*adjust_sensitivity)(float delta);
+    void (*get_stats)(char *buffer, size_t size);
+    void (*get_latency)(char *buffer, size_t size);
+    void (*reset_latency)(void);
+    bool (*set_option)(const char *key, const char *value);
 } SocketServer;
 
 // Initialize and start the socket server
@@ -33,4 +112,9 @@ bool start_socket_server(SocketServer *server);
 // Stop the socket server
 void stop_socket_server(SocketServer *server);
 
+// Publish the latest orientation and emitted motion for subscribers. Called
+// from the emitter thread; cheap, and nearly free when nobody is subscribed.
+void socket_server_publish_pose(SocketServer *server, float yaw, float pitch, float roll);
+void socket_server_publish_motion(SocketServer *server, int move_x, int move_y, int scroll);
+
 #endif // SOCKET_SERVER_H
\ No newline at end of file
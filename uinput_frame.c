@@ -0,0 +1,59 @@
+#include <string.h>
+#include <unistd.h>
+#include <stdatomic.h>
+
+#include "uinput_frame.h"
+
+static atomic_ullong frames_flushed;
+static atomic_ullong events_written;
+static atomic_ullong syscalls_made;
+static atomic_ullong write_errors;
+
+void uinput_frame_begin(UinputFrame *frame) {
+    frame->count = 0;
+}
+
+void uinput_frame_add(UinputFrame *frame, uint16_t type, uint16_t code, int32_t value) {
+    if (type == EV_REL && value == 0) return;
+
+    // Leave room for the SYN_REPORT
+    if (frame->count >= UINPUT_FRAME_MAX - 1) return;
+
+    struct input_event *ev = &frame->events[frame->count++];
+    memset(ev, 0, sizeof(*ev));
+    ev->type = type;
+    ev->code = code;
+    ev->value = value;
+}
+
+bool uinput_frame_flush(UinputFrame *frame, int fd) {
+    if (frame->count == 0) return true;
+
+    int events = frame->count;
+    struct input_event *syn = &frame->events[frame->count++];
+    memset(syn, 0, sizeof(*syn));
+    syn->type = EV_SYN;
+    syn->code = SYN_REPORT;
+    syn->value = 0;
+
+    // The events are contiguous, so one write hands uinput the whole frame
+    size_t size = frame->count * sizeof(struct input_event);
+    ssize_t written = write(fd, frame->events, size);
+    frame->count = 0;
+
+    atomic_fetch_add_explicit(&syscalls_made, 1, memory_order_relaxed);
+    if (written != (ssize_t)size) {
+        atomic_fetch_add_explicit(&write_errors, 1, memory_order_relaxed);
+        return false;
+    }
+    atomic_fetch_add_explicit(&frames_flushed, 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&events_written, events, memory_order_relaxed);
+    return true;
+}
+
+void uinput_frame_get_stats(UinputFrameStats *stats) {
+    stats->frames = atomic_load(&frames_flushed);
+    stats->events = atomic_load(&events_written);
+    stats->syscalls = atomic_load(&syscalls_made);
+    stats->errors = atomic_load(&write_errors);
+}
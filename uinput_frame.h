@@ -0,0 +1,41 @@
+#ifndef UINPUT_FRAME_H
+#define UINPUT_FRAME_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <linux/input.h>
+
+// Most events one frame can hold, including the closing SYN_REPORT
+#define UINPUT_FRAME_MAX 16
+
+// Gathers every event belonging to one IMU sample so it reaches the kernel as
+// a single write ending in a single SYN_REPORT. The compositor sees motion
+// and scroll from the same sample as one atomic evdev frame.
+typedef struct {
+    struct input_event events[UINPUT_FRAME_MAX];
+    int count;
+} UinputFrame;
+
+// Emission counters, shared by every frame flushed in this process
+typedef struct {
+    uint64_t frames;            // Frames flushed
+    uint64_t events;            // Events written, excluding SYN_REPORT
+    uint64_t syscalls;          // write() calls made
+    uint64_t errors;            // Failed or short writes
+} UinputFrameStats;
+
+// Start an empty frame
+void uinput_frame_begin(UinputFrame *frame);
+
+// Add an event; zero-valued relative events are skipped
+void uinput_frame_add(UinputFrame *frame, uint16_t type, uint16_t code, int32_t value);
+
+// Terminate the frame with SYN_REPORT and write it in one syscall.
+// Empty frames are not written. Returns false if the write failed.
+bool uinput_frame_flush(UinputFrame *frame, int fd);
+
+// Snapshot of the process-wide counters
+void uinput_frame_get_stats(UinputFrameStats *stats);
+
+#endif // UINPUT_FRAME_H
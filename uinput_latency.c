@@ -0,0 +1,245 @@
+// End-to-end latency of the Wayland daemon's events: from the IMU callback
+// receiving a sample to the resulting frame being read from the evdev node
+// of the "Viture Head Mouse" uinput device.
+//
+// The emission side is timestamped through the shared-memory pose export
+// (pose_export.h), which carries each sample's arrival time in imuCallback.
+// Every REL_X/REL_Y frame read from the device is matched to the newest
+// sample that arrived before the kernel stamped the frame. With the evdev
+// clock switched to CLOCK_MONOTONIC the delay splits into:
+//   callback_to_evdev   imuCallback until the kernel accepted the uinput write
+//   evdev_to_reader     kernel until this process read the event
+//   end_to_end          the two together
+//
+// Runs an idle phase, then a phase with busy threads loading every CPU.
+// Start the daemon first, with the mock SDK to run without glasses:
+//   VITURE_MOCK_SIGNAL=slow_pan ./head_mouse_wayland &
+//   ./uinput_latency --seconds 10
+// Prints one key=value line per phase.
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <glob.h>
+#include <poll.h>
+#include <pthread.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <linux/input.h>
+
+#include "latency_histogram.h"
+#include "pose_export.h"
+
+// Name setup_uinput_device gives the daemon's device
+#define DEVICE_NAME "Viture Head Mouse"
+#define DEFAULT_SECONDS 10
+
+// Frames read in one phase and their delays
+typedef struct {
+    unsigned long long frames;  // Frames with movement
+    unsigned long long matched; // Frames matched to a sample
+    LatencyHistogram callback_to_evdev;
+    LatencyHistogram evdev_to_reader;
+    LatencyHistogram end_to_end;
+} Phase;
+
+static atomic_bool loading;
+
+static void print_usage(const char *prog) {
+    printf("Usage: %s [--seconds N] [--load THREADS] [--device PATH]\n", prog);
+    printf("\nOptions:\n");
+    printf("  --seconds N       Length of each phase (default %d)\n", DEFAULT_SECONDS);
+    printf("  --load THREADS    Busy threads in the loaded phase (default: one per CPU, 0 skips it)\n");
+    printf("  --device PATH     Event node to read instead of searching for \"%s\"\n", DEVICE_NAME);
+    printf("\nEnvironment:\n");
+    printf("  %s  Pose export to read arrival times from\n", POSE_EXPORT_NAME_ENV);
+}
+
+// Find the daemon's event node by device name
+static int open_device(char *path, size_t size) {
+    glob_t nodes;
+    if (glob("/dev/input/event*", 0, NULL, &nodes) != 0) {
+        return -1;
+    }
+
+    int fd = -1;
+    for (size_t i = 0; i < nodes.gl_pathc && fd < 0; i++) {
+        int candidate = open(nodes.gl_pathv[i], O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+        if (candidate < 0) continue;
+
+        char name[256] = "";
+        if (ioctl(candidate, EVIOCGNAME(sizeof(name)), name) >= 0 && strcmp(name, DEVICE_NAME) == 0) {
+            snprintf(path, size, "%s", nodes.gl_pathv[i]);
+            fd = candidate;
+        } else {
+            close(candidate);
+        }
+    }
+    globfree(&nodes);
+    return fd;
+}
+
+static void* busy_thread(void *arg) {
+    volatile unsigned long spin = 0;
+    while (atomic_load_explicit(&loading, memory_order_relaxed)) {
+        spin++;
+    }
+    return NULL;
+}
+
+// Read frames for the given time, matching each to the sample that caused it
+static void run_phase(int fd, bool kernel_clock, const PoseExportShared *pose,
+                      int seconds, Phase *phase) {
+    memset(phase, 0, sizeof(*phase));
+    PoseExportSample previous = {0};
+    bool moved = false;
+
+    uint64_t end_ns = latency_now_ns() + (uint64_t)seconds * 1000000000ull;
+    while (latency_now_ns() < end_ns) {
+        struct pollfd pfd = { .fd = fd, .events = POLLIN };
+        if (poll(&pfd, 1, 100) <= 0) continue;
+
+        struct input_event events[64];
+        ssize_t n = read(fd, events, sizeof(events));
+        if (n <= 0) {
+            if (n < 0 && errno == EAGAIN) continue;
+            fprintf(stderr, "Device went away\n");
+            return;
+        }
+        uint64_t read_ns = latency_now_ns();
+
+        for (size_t i = 0; i < (size_t)n / sizeof(struct input_event); i++) {
+            const struct input_event *ev = &events[i];
+            if (ev->type == EV_REL && (ev->code == REL_X || ev->code == REL_Y)) {
+                moved = true;
+            }
+            if (ev->type != EV_SYN || ev->code != SYN_REPORT || !moved) continue;
+            moved = false;
+            phase->frames++;
+
+            uint64_t event_ns = kernel_clock ?
+                (uint64_t)ev->input_event_sec * 1000000000ull + (uint64_t)ev->input_event_usec * 1000ull :
+                read_ns;
+
+            // The newest sample may have arrived after this frame was written;
+            // then the frame came from the one before it
+            PoseExportSample sample;
+            if (!pose_export_read(pose, &sample)) continue;
+            const PoseExportSample *source = NULL;
+            if (sample.arrival_ns <= event_ns) {
+                source = &sample;
+            } else if (previous.count + 1 == sample.count && previous.arrival_ns <= event_ns) {
+                source = &previous;
+            }
+
+            if (source) {
+                phase->matched++;
+                latency_histogram_record(&phase->end_to_end, read_ns - source->arrival_ns);
+                if (kernel_clock) {
+                    latency_histogram_record(&phase->callback_to_evdev, event_ns - source->arrival_ns);
+                    latency_histogram_record(&phase->evdev_to_reader, read_ns - event_ns);
+                }
+            }
+            previous = sample;
+        }
+    }
+}
+
+static void print_phase(const char *name, int threads, bool kernel_clock, Phase *phase) {
+    char end_to_end[256], callback[256], reader[256];
+    latency_histogram_format(&phase->end_to_end, "end_to_end", end_to_end, sizeof(end_to_end));
+    printf("phase=%s load_threads=%d frames=%llu matched=%llu %s",
+           name, threads, phase->frames, phase->matched, end_to_end);
+    if (kernel_clock) {
+        latency_histogram_format(&phase->callback_to_evdev, "callback_to_evdev", callback, sizeof(callback));
+        latency_histogram_format(&phase->evdev_to_reader, "evdev_to_reader", reader, sizeof(reader));
+        printf(" %s %s", callback, reader);
+    }
+    printf("\n");
+    fflush(stdout);
+}
+
+int main(int argc, char *argv[]) {
+    int seconds = DEFAULT_SECONDS;
+    int threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    const char *device = NULL;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--seconds") == 0 && i + 1 < argc) {
+            seconds = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--load") == 0 && i + 1 < argc) {
+            threads = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--device") == 0 && i + 1 < argc) {
+            device = argv[++i];
+        } else {
+            print_usage(argv[0]);
+            return strcmp(argv[i], "--help") == 0 ? 0 : 1;
+        }
+    }
+    if (seconds <= 0 || threads < 0) {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    char path[256];
+    int fd;
+    if (device) {
+        snprintf(path, sizeof(path), "%s", device);
+        fd = open(path, O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+    } else {
+        fd = open_device(path, sizeof(path));
+    }
+    if (fd < 0) {
+        fprintf(stderr, "Cannot open the %s event node (is head_mouse_wayland running, and can you read /dev/input?)\n",
+                DEVICE_NAME);
+        return 1;
+    }
+
+    // Stamp events with the same clock as the daemon's arrival times
+    int clock = CLOCK_MONOTONIC;
+    bool kernel_clock = ioctl(fd, EVIOCSCLOCKID, &clock) == 0;
+    if (!kernel_clock) {
+        fprintf(stderr, "Warning: %s has no evdev clock, only measuring end to end\n", path);
+    }
+
+    const PoseExportShared *pose = pose_export_map(NULL);
+    if (!pose) {
+        fprintf(stderr, "Cannot map the pose export %s (is the daemon running?)\n", pose_export_name());
+        close(fd);
+        return 1;
+    }
+    fprintf(stderr, "Reading %s for %d s idle, then %d s with %d busy threads\n",
+            path, seconds, threads > 0 ? seconds : 0, threads);
+
+    Phase phase;
+    run_phase(fd, kernel_clock, pose, seconds, &phase);
+    print_phase("idle", 0, kernel_clock, &phase);
+
+    if (threads > 0) {
+        pthread_t *busy = calloc(threads, sizeof(pthread_t));
+        int started = 0;
+        atomic_store(&loading, true);
+        while (busy && started < threads && pthread_create(&busy[started], NULL, busy_thread, NULL) == 0) {
+            started++;
+        }
+
+        run_phase(fd, kernel_clock, pose, seconds, &phase);
+
+        atomic_store(&loading, false);
+        for (int i = 0; i < started; i++) {
+            pthread_join(busy[i], NULL);
+        }
+        free(busy);
+        print_phase("loaded", started, kernel_clock, &phase);
+    }
+
+    pose_export_unmap(pose);
+    close(fd);
+    return 0;
+}
@@ -0,0 +1,102 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+#include <dirent.h>
+#include <poll.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/inotify.h>
+#include <sys/stat.h>
+#include <sys/sysmacros.h>
+#include <linux/uinput.h>
+
+#include "uinput_ready.h"
+
+#define INPUT_DIR       "/dev/input"
+#define UDEV_DATA_DIR   "/run/udev/data"
+
+// Longest single wait, in case a change happens somewhere we don't watch
+#define RECHECK_MS 50
+
+static int64_t now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+// Name of the device's event node ("event7"), from sysfs
+static bool find_event_name(const char *sysname, char *event, size_t size) {
+    char path[128];
+    snprintf(path, sizeof(path), "/sys/devices/virtual/input/%s", sysname);
+    DIR *dir = opendir(path);
+    if (!dir) return false;
+
+    bool found = false;
+    struct dirent *entry;
+    while (!found && (entry = readdir(dir))) {
+        if (strncmp(entry->d_name, "event", 5) == 0) {
+            snprintf(event, size, "%s", entry->d_name);
+            found = true;
+        }
+    }
+    closedir(dir);
+    return found;
+}
+
+// The node exists and, with udev running, udev has recorded it
+static bool node_ready(const char *event, bool udev, char *node, size_t size) {
+    snprintf(node, size, INPUT_DIR "/%s", event);
+    struct stat st;
+    if (stat(node, &st) < 0 || !S_ISCHR(st.st_mode)) return false;
+    if (!udev) return true;
+
+    char entry[64];
+    snprintf(entry, sizeof(entry), UDEV_DATA_DIR "/c%u:%u", major(st.st_rdev), minor(st.st_rdev));
+    return access(entry, F_OK) == 0;
+}
+
+bool uinput_wait_ready(int fd, int timeout_ms, char *node, size_t size) {
+    char sysname[64];
+    if (ioctl(fd, UI_GET_SYSNAME(sizeof(sysname)), sysname) < 0) {
+        usleep(timeout_ms * 1000);
+        return false;
+    }
+
+    // Watch before the first check, so nothing created after it is missed
+    int inotify_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (inotify_fd >= 0) {
+        inotify_add_watch(inotify_fd, INPUT_DIR, IN_CREATE | IN_ATTRIB);
+        inotify_add_watch(inotify_fd, UDEV_DATA_DIR, IN_CREATE | IN_MOVED_TO);
+    }
+    bool udev = access(UDEV_DATA_DIR, F_OK) == 0;
+
+    int64_t deadline = now_ms() + timeout_ms;
+    bool ready = false;
+    char event[256];
+    for (;;) {
+        if (find_event_name(sysname, event, sizeof(event)) && node_ready(event, udev, node, size)) {
+            ready = true;
+            break;
+        }
+
+        int64_t remaining = deadline - now_ms();
+        if (remaining <= 0) break;
+        int wait = remaining < RECHECK_MS ? (int)remaining : RECHECK_MS;
+
+        if (inotify_fd < 0) {
+            usleep(wait * 1000);
+            continue;
+        }
+        struct pollfd pfd = { .fd = inotify_fd, .events = POLLIN };
+        if (poll(&pfd, 1, wait) > 0) {
+            char buffer[4096];
+            while (read(inotify_fd, buffer, sizeof(buffer)) > 0) {
+            }
+        }
+    }
+
+    if (inotify_fd >= 0) close(inotify_fd);
+    return ready;
+}
@@ -0,0 +1,17 @@
+#ifndef UINPUT_READY_H
+#define UINPUT_READY_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+// Wait for a uinput device created with UI_DEV_CREATE to become usable: its
+// event node exists in /dev/input and, where udev runs, udev has finished
+// processing it (which is when compositors using libinput pick it up).
+//
+// The node is found through UI_GET_SYSNAME and sysfs, and inotify on
+// /dev/input and the udev database wakes the wait as soon as it appears.
+// Returns true with the node's path in node, or false after timeout_ms. On
+// kernels without UI_GET_SYSNAME it just sleeps for timeout_ms.
+bool uinput_wait_ready(int fd, int timeout_ms, char *node, size_t size);
+
+#endif // UINPUT_READY_H
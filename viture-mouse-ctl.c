@@ -5,13 +5,20 @@
 #include <sys/socket.h>
 #include <sys/un.h>
 #include <errno.h>
+#include <stdbool.h>
+#include <time.h>
 
 #define SOCKET_PATH_ENV "VITURE_MOUSE_SOCKET"
 #define DEFAULT_SOCKET_PATH "/tmp/viture-head-mouse.sock"
 #define USER_SOCKET_PATH "/tmp/viture-head-mouse-user.sock"
 
+// Size of the daemon's line buffer; a command line, newline included, has to
+// fit with a terminating NUL to spare
+#define SOCKET_LINE_MAX 256
+
 static void print_usage(const char *prog) {
     printf("Usage: %s COMMAND [ARGS]\n", prog);
+    printf("       %s - | --batch [FILE]\n", prog);
     printf("\nCommands:\n");
     printf("  toggle              Toggle head tracking on/off\n");
     printf("  recenter            Reset center position to current orientation\n");
@@ -19,8 +26,17 @@ static void print_usage(const char *prog) {
     printf("  resume              Resume tracking after pause\n");
     printf("  reload              Reload configuration from file\n");
     printf("  status              Show current status\n");
+    printf("  stats               Show emitter queue statistics\n");
+    printf("  latency             Show callback and emission latency percentiles\n");
+    printf("  latency reset       Clear the latency histograms\n");
     printf("  sensitivity VALUE   Set sensitivity (e.g., 45)\n");
     printf("  sensitivity +/-VAL  Adjust sensitivity (e.g., +5, -5)\n");
+    printf("  set KEY VALUE       Change a config file setting (e.g., set filter one_euro)\n");
+    printf("  watch [RATE]        Stream orientation, motion and scroll (default 30 Hz)\n");
+    printf("\nBatch mode:\n");
+    printf("  Reads one command per line from stdin or FILE and sends them all over one\n");
+    printf("  connection. Each response is printed with its round-trip time; the exit\n");
+    printf("  status is 1 if any command failed, 2 if the connection was lost.\n");
     printf("\nEnvironment:\n");
     printf("  VITURE_MOUSE_SOCKET  Override socket path (default: %s)\n", DEFAULT_SOCKET_PATH);
 }
@@ -33,30 +49,12 @@ static const char* get_socket_path() {
     return (getuid() == 0) ? DEFAULT_SOCKET_PATH : USER_SOCKET_PATH;
 }
 
-int main(int argc, char *argv[]) {
-    if (argc < 2) {
-        print_usage(argv[0]);
-        return 1;
-    }
-    
-    // Build command string
-    char command[256];
-    if (strcmp(argv[1], "sensitivity") == 0 && argc >= 3) {
-        snprintf(command, sizeof(command), "sensitivity %s", argv[2]);
-    } else if (argc == 2) {
-        strncpy(command, argv[1], sizeof(command) - 1);
-        command[sizeof(command) - 1] = '\0';
-    } else {
-        fprintf(stderr, "Error: Invalid command\n");
-        print_usage(argv[0]);
-        return 1;
-    }
-    
-    // Create socket
+// Connect to the daemon's control socket, or return -1
+static int connect_daemon(void) {
     int sock = socket(AF_UNIX, SOCK_STREAM, 0);
     if (sock < 0) {
         perror("Failed to create socket");
-        return 1;
+        return -1;
     }
     
     // Connect to server
@@ -74,30 +72,174 @@ int main(int argc, char *argv[]) {
             perror("Failed to connect to socket");
         }
         close(sock);
+        return -1;
+    }
+    return sock;
+}
+
+// Send one command and read its one-line response. Returns false if the
+// connection failed.
+static bool send_command(int sock, const char *command, char *response, size_t size) {
+    char line[SOCKET_LINE_MAX + 1];
+    snprintf(line, sizeof(line), "%s\n", command);
+    if (send(sock, line, strlen(line), MSG_NOSIGNAL) < 0) {
+        perror("Failed to send command");
+        return false;
+    }
+    
+    size_t used = 0;
+    while (used < size - 1) {
+        ssize_t n = recv(sock, response + used, size - 1 - used, 0);
+        if (n <= 0) break;
+        used += n;
+        if (response[used - 1] == '\n') break;
+    }
+    response[used] = '\0';
+    if (used == 0) {
+        fprintf(stderr, "Error: connection closed by viture-head-mouse\n");
+        return false;
+    }
+    return true;
+}
+
+static double elapsed_ms(const struct timespec *start) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (now.tv_sec - start->tv_sec) * 1000.0 + (now.tv_nsec - start->tv_nsec) / 1e6;
+}
+
+// Run one command per input line over a single connection, printing each
+// response with its round-trip time. Blank lines and # comments are skipped;
+// a line too long for the daemon is skipped whole and counts as failed.
+// Returns the exit status: 0 if every command succeeded, 1 if any failed,
+// 2 if the connection was lost.
+static int run_batch(int sock, FILE *input) {
+    char command[SOCKET_LINE_MAX - 1];
+    char response[512];
+    int commands = 0, answered = 0, failed = 0;
+    double total_ms = 0, max_ms = 0;
+    
+    while (fgets(command, sizeof(command), input)) {
+        // A full buffer without a newline is only the start of the line;
+        // sending it would run the rest as a second command
+        size_t len = strlen(command);
+        if (len == sizeof(command) - 1 && command[len - 1] != '\n') {
+            int c;
+            bool rest = false;
+            while ((c = getc(input)) != EOF && c != '\n') rest = true;
+            if (rest) {
+                fprintf(stderr, "Error: command longer than %zu characters skipped\n",
+                        sizeof(command) - 1);
+                commands++;
+                failed++;
+                continue;
+            }
+        }
+        command[strcspn(command, "\r\n")] = '\0';
+        const char *start = command + strspn(command, " \t");
+        if (*start == '\0' || *start == '#') continue;
+        
+        struct timespec sent;
+        clock_gettime(CLOCK_MONOTONIC, &sent);
+        if (!send_command(sock, start, response, sizeof(response))) {
+            return 2;
+        }
+        double rtt = elapsed_ms(&sent);
+        
+        response[strcspn(response, "\n")] = '\0';
+        printf("%s\t%.3f ms\n", response, rtt);
+        fflush(stdout);
+        
+        commands++;
+        answered++;
+        total_ms += rtt;
+        if (rtt > max_ms) max_ms = rtt;
+        if (strncmp(response, "ERROR:", 6) == 0) failed++;
+    }
+    
+    fprintf(stderr, "%d commands, %d failed, rtt avg %.3f ms max %.3f ms\n",
+            commands, failed, answered ? total_ms / answered : 0.0, max_ms);
+    return failed ? 1 : 0;
+}
+
+int main(int argc, char *argv[]) {
+    if (argc < 2) {
+        print_usage(argv[0]);
+        return 1;
+    }
+    
+    // Batch mode: commands from stdin or a file over one connection
+    if (strcmp(argv[1], "-") == 0 || strcmp(argv[1], "--batch") == 0) {
+        if (argc > 3 || (argc == 3 && strcmp(argv[1], "-") == 0)) {
+            fprintf(stderr, "Error: Invalid command\n");
+            print_usage(argv[0]);
+            return 1;
+        }
+        
+        FILE *input = stdin;
+        if (argc == 3 && strcmp(argv[2], "-") != 0) {
+            input = fopen(argv[2], "r");
+            if (!input) {
+                perror(argv[2]);
+                return 1;
+            }
+        }
+        
+        int sock = connect_daemon();
+        if (sock < 0) return 1;
+        int status = run_batch(sock, input);
+        close(sock);
+        if (input != stdin) fclose(input);
+        return status;
+    }
+    
+    // Build command string
+    char command[256];
+    bool watch = false;
+    if (strcmp(argv[1], "watch") == 0 && argc <= 3) {
+        snprintf(command, sizeof(command), "subscribe%s%s", argc == 3 ? " " : "", argc == 3 ? argv[2] : "");
+        watch = true;
+    } else if (strcmp(argv[1], "sensitivity") == 0 && argc >= 3) {
+        snprintf(command, sizeof(command), "sensitivity %s", argv[2]);
+    } else if (strcmp(argv[1], "latency") == 0 && argc == 3) {
+        snprintf(command, sizeof(command), "latency %s", argv[2]);
+    } else if (strcmp(argv[1], "set") == 0 && argc == 4) {
+        snprintf(command, sizeof(command), "set %s %s", argv[2], argv[3]);
+    } else if (argc == 2) {
+        strncpy(command, argv[1], sizeof(command) - 1);
+        command[sizeof(command) - 1] = '\0';
+    } else {
+        fprintf(stderr, "Error: Invalid command\n");
+        print_usage(argv[0]);
         return 1;
     }
     
-    // Send command
-    if (send(sock, command, strlen(command), 0) < 0) {
-        perror("Failed to send command");
+    int sock = connect_daemon();
+    if (sock < 0) return 1;
+    
+    char response[512];
+    if (!send_command(sock, command, response, sizeof(response))) {
         close(sock);
         return 1;
     }
+    printf("%s", response);
     
-    // Read response
-    char response[256];
-    ssize_t n = recv(sock, response, sizeof(response) - 1, 0);
-    if (n > 0) {
-        response[n] = '\0';
-        printf("%s", response);
-        
-        // Check if command succeeded
-        if (strncmp(response, "ERROR:", 6) == 0) {
-            close(sock);
-            return 1;
+    // Check if command succeeded
+    if (strncmp(response, "ERROR:", 6) == 0) {
+        close(sock);
+        return 1;
+    }
+    
+    // Watch: print records as they arrive until the daemon goes away
+    if (watch) {
+        fflush(stdout);
+        ssize_t n;
+        while ((n = recv(sock, response, sizeof(response), 0)) > 0) {
+            fwrite(response, 1, n, stdout);
+            fflush(stdout);
         }
     }
     
     close(sock);
     return 0;
-}
\ No newline at end of file
+}
@@ -0,0 +1,68 @@
+#include <stdio.h>
+#include <stdatomic.h>
+#include <X11/extensions/XTest.h>
+
+#include "xtest_frame.h"
+
+static atomic_ullong frames_flushed;
+static atomic_ullong requests_sent;
+static atomic_ullong x_errors;
+
+// Called by Xlib while reading, on whichever thread flushed
+static int count_error(Display *display, XErrorEvent *error) {
+    // Report the first one, count the rest
+    if (atomic_fetch_add(&x_errors, 1) == 0) {
+        char text[128];
+        XGetErrorText(display, error->error_code, text, sizeof(text));
+        fprintf(stderr, "Warning: X error in request %u.%u: %s\n",
+                error->request_code, error->minor_code, text);
+    }
+    return 0;
+}
+
+void xtest_frame_init(void) {
+    XSetErrorHandler(count_error);
+}
+
+void xtest_frame_begin(XTestFrame *frame, Display *display) {
+    frame->display = display;
+    frame->first_request = NextRequest(display);
+}
+
+void xtest_frame_motion(XTestFrame *frame, int dx, int dy) {
+    if (dx == 0 && dy == 0) return;
+    XTestFakeRelativeMotionEvent(frame->display, dx, dy, CurrentTime);
+}
+
+void xtest_frame_position(XTestFrame *frame, int screen, int x, int y) {
+    XTestFakeMotionEvent(frame->display, screen, x, y, CurrentTime);
+}
+
+void xtest_frame_click(XTestFrame *frame, unsigned int button, int count) {
+    for (int i = 0; i < count; i++) {
+        XTestFakeButtonEvent(frame->display, button, True, CurrentTime);
+        XTestFakeButtonEvent(frame->display, button, False, CurrentTime);
+    }
+}
+
+void xtest_frame_flush(XTestFrame *frame) {
+    unsigned long requests = NextRequest(frame->display) - frame->first_request;
+    if (requests == 0) return;
+
+    // Flush, then read without blocking so errors reach count_error. No
+    // events are selected, so anything queued is dropped.
+    int queued = XEventsQueued(frame->display, QueuedAfterFlush);
+    while (queued-- > 0) {
+        XEvent event;
+        XNextEvent(frame->display, &event);
+    }
+
+    atomic_fetch_add_explicit(&frames_flushed, 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&requests_sent, requests, memory_order_relaxed);
+}
+
+void xtest_frame_get_stats(XTestFrameStats *stats) {
+    stats->frames = atomic_load(&frames_flushed);
+    stats->requests = atomic_load(&requests_sent);
+    stats->errors = atomic_load(&x_errors);
+}
@@ -0,0 +1,51 @@
+#ifndef XTEST_FRAME_H
+#define XTEST_FRAME_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <X11/Xlib.h>
+
+// Gathers the XTest requests for one frame of output (motion, a warp and any
+// scroll clicks) in Xlib's output buffer and sends them with a single flush,
+// so a frame costs one write to the X server however many events it holds.
+// The X11 counterpart of uinput_frame.h.
+//
+// Nothing waits for the server: errors come back asynchronously and are
+// picked up by the non-blocking read that follows each flush, then counted by
+// the handler xtest_frame_init installs instead of Xlib's default (which
+// exits the process).
+typedef struct {
+    Display *display;
+    unsigned long first_request; // Sequence number of the frame's first request
+} XTestFrame;
+
+// Emission counters, shared by every frame flushed in this process
+typedef struct {
+    uint64_t frames;            // Frames flushed, one flush each
+    uint64_t requests;          // X requests sent
+    uint64_t errors;            // X errors reported by the server
+} XTestFrameStats;
+
+// Install the error handler (once, before the first frame)
+void xtest_frame_init(void);
+
+// Start an empty frame on display
+void xtest_frame_begin(XTestFrame *frame, Display *display);
+
+// Move the pointer by dx, dy; nothing is queued for zero movement
+void xtest_frame_motion(XTestFrame *frame, int dx, int dy);
+
+// Warp the pointer to x, y on screen
+void xtest_frame_position(XTestFrame *frame, int screen, int x, int y);
+
+// Press and release button count times
+void xtest_frame_click(XTestFrame *frame, unsigned int button, int count);
+
+// Send the frame's requests in one flush and read back whatever the server
+// has sent without blocking. Empty frames are not flushed.
+void xtest_frame_flush(XTestFrame *frame);
+
+// Snapshot of the process-wide counters
+void xtest_frame_get_stats(XTestFrameStats *stats);
+
+#endif // XTEST_FRAME_H